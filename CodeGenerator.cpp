@@ -10,6 +10,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include "CodeGenerator.h"
 
 using namespace std;
@@ -20,11 +21,41 @@ using namespace std;
 /********************************************************************************/
 CodeGenerator::CodeGenerator (string fileNamePrefix, LexicalAnalyzer * L)
 {
+	Phase phase (GENERATE_P);
 	lex = L;
+	inFunction = false;
+	streaming = false;
 	string cppname = fileNamePrefix + ".cpp"; 
-	cpp.open (cppname.c_str());
+	cpp.open (cppname);
+	Prologue (cppname);
+	cpp << "extern const Object symbols [];\n";
+	cpp << "extern Object constants [];\n\n";
+	if (pipelined)
+		writer = thread (&CodeGenerator::Write, this);
+}
+
+/********************************************************************************/
+/* This constructor writes the C++ code to the open descriptor fd as the       */
+/* program is read. Each function is written when its define ends, with the    */
+/* symbols and constants it uses, and the tables are started again, so that    */
+/* nothing kept grows with the length of the program.                           */
+/********************************************************************************/
+CodeGenerator::CodeGenerator (int fd, LexicalAnalyzer * L)
+{
+	Phase phase (GENERATE_P);
+	lex = L;
+	inFunction = false;
+	streaming = true;
+	cpp.attach (fd, "standard output");
+	Prologue ("standard output");
+	if (pipelined)
+		writer = thread (&CodeGenerator::Write, this);
+}
+
+void CodeGenerator::Prologue (const string & name)
+{
 	cpp << "// Autogenerated PL460 to C++ Code\n";
-	cpp << "// File: " << cppname << "\n\n";
+	cpp << "// File: " << name << "\n\n";
 	cpp << "#include <iostream>\n";
 	cpp << "#include \"Object.h\"\n";
 	cpp << "using namespace std;\n\n";
@@ -32,20 +63,166 @@ CodeGenerator::CodeGenerator (string fileNamePrefix, LexicalAnalyzer * L)
 
 /********************************************************************************/
 /* This function will be called when the CodeGenerator object is deleted. It    */
-/* closes the generated .cpp file.						                        */
+/* writes the table of symbols interned by the lexical analyzer and the table   */
+/* of quoted literals, which the generated code indexes by number, and closes   */
+/* the generated .cpp file. Both are built once, before main runs.              */
 /********************************************************************************/
 CodeGenerator::~CodeGenerator ()
 {
+	Phase phase (GENERATE_P);
+	if (!streaming)
+	{
+		ostringstream tables;
+		WriteTables (tables, "\n");
+		string code = tables.str ();
+		Emit (code);
+	}
+	if (writer.joinable ())
+	{
+		chunks.Back ().clear ();
+		chunks.Push ();
+		writer.join ();
+	}
 	cpp.close();
 }
 
+/********************************************************************************/
+/* This function writes code to the .cpp file or, when pipelined, hands it to  */
+/* the writer thread. The code is swapped into the Ring, so code is left with   */
+/* the storage of a chunk already written. When streaming, each chunk is sent  */
+/* on at once, so a reader of the output has each function as its define ends. */
+/********************************************************************************/
+void CodeGenerator::Emit (string & code)
+{
+	if (!writer.joinable ())
+	{
+		cpp << code;
+		if (streaming)
+			cpp.Send ();
+	}
+	else if (!code.empty ())
+	{
+		chunks.Back ().swap (code);
+		chunks.Push ();
+	}
+}
+
+/********************************************************************************/
+/* This function runs on the writer thread, writing each chunk of code until   */
+/* the empty one that follows the last.                                         */
+/********************************************************************************/
+void CodeGenerator::Write ()
+{
+	for (bool more = true; more; )
+	{
+		string & code = chunks.Front ();
+		more = !code.empty ();
+		cpp << code;
+		if (streaming && more)
+			cpp.Send ();
+		chunks.Pop ();
+	}
+}
+
+/********************************************************************************/
+/* This function writes the symbols table and the constants table to out, each */
+/* declaration preceded by storage.                                             */
+/********************************************************************************/
+void CodeGenerator::WriteTables (ostream & out, const string & storage)
+{
+	const vector <string> & names = lex->GetSymbols ();
+	if (!names.empty ())
+	{
+		out << storage << "const Object symbols [] = {";
+		for (size_t i = 0; i < names.size (); i++)
+			out << (i ? ", " : "") << "symbol (\"" << names[i] << "\")";
+		out << "};\n";
+	}
+	if (!literals.empty ())
+	{
+		out << storage << "Object constants [] = {";
+		for (size_t i = 0; i < literals.size (); i++)
+		{
+			out << (i ? ",\n\t" : "\n\t") << "Object (\"";
+			for (char c : literals[i])
+			{
+				if (c == '"' || c == '\\')
+					out << '\\';
+				out << c;
+			}
+			out << "\")";
+		}
+		out << "};\n";
+	}
+}
+
 /********************************************************************************/
 /* This function will be called by the SyntacticAnalyzer to write lines of C++  */
-/* code to the .cpp file.							                            */
+/* code to the .cpp file, or to the body of the function being translated.      */
 /********************************************************************************/
 void CodeGenerator::WriteCode (int tabs, string code)
 {
-	for (int t = 0; t < tabs; t++)
-		cpp << '\t';
-	cpp << code;
+	Phase phase (GENERATE_P);
+	if (inFunction)
+	{
+		function.append (tabs, '\t');
+		function += code;
+		return;
+	}
+	code.insert (0, tabs, '\t');
+	Emit (code);
+}
+
+/********************************************************************************/
+/* This function will be called by the SyntacticAnalyzer for a quoted literal.  */
+/* It returns the name of the constant holding it in the generated program;    */
+/* identical literals share one constant, unless they hold a vector, which      */
+/* vector-set! can change: each of those has a constant of its own.             */
+/********************************************************************************/
+string CodeGenerator::Literal (const string & text)
+{
+	Phase phase (GENERATE_P);
+	if (text[0] != '"' && text.find ("#(") != string::npos)
+	{
+		literals.push_back (text);
+		return "constants[" + to_string (literals.size () - 1) + "]";
+	}
+	auto found = literalIds.emplace (text, literals.size ());
+	if (found.second)
+		literals.push_back (text);
+	return "constants[" + to_string (found.first->second) + "]";
+}
+
+/********************************************************************************/
+/* These functions will be called by the SyntacticAnalyzer around the body of a */
+/* define. The body is held until the end of the define, when the analyzer      */
+/* knows whether the Objects the function builds can escape its activation; if  */
+/* they cannot, the function opens a Region for them. When streaming, its      */
+/* tables are static locals built on its first call, ahead of the Region.       */
+/********************************************************************************/
+void CodeGenerator::BeginFunction (const string & header)
+{
+	Phase phase (GENERATE_P);
+	inFunction = true;
+	function = header;
+}
+
+void CodeGenerator::EndFunction (bool region)
+{
+	Phase phase (GENERATE_P);
+	inFunction = false;
+	size_t body = function.find ('\n') + 1;
+	if (region)
+		function.insert (body, "\tRegion region;\n");
+	if (streaming)
+	{
+		ostringstream tables;
+		WriteTables (tables, "\tstatic ");
+		function.insert (body, tables.str ());
+		literalIds.clear ();
+		literals.clear ();
+		lex->ForgetSymbols ();
+	}
+	Emit (function);
+	function.clear ();
 }
@@ -14,6 +14,9 @@
 
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <thread>
+#include <vector>
 #include "LexicalAnalyzer.h"
 
 using namespace std;
@@ -25,17 +28,34 @@ using namespace std;
 *              program.                                                        *
 *              The functions in this class will be called by the Syntactic     *
 *              analyzer.                                                       *
+*              When pipelined, the code is handed through a Ring to a writer   *
+*              thread, which writes it to the .cpp file.                       *
 *******************************************************************************/
 
 class CodeGenerator 
 {
     public:
 	CodeGenerator (string fileNamePrefix, LexicalAnalyzer * L);
+	CodeGenerator (int fd, LexicalAnalyzer * L);
 	~CodeGenerator ();
 	void WriteCode (int tabs, string code);
+	string Literal (const string & text);
+	void BeginFunction (const string & header);
+	void EndFunction (bool region);
     private:
 	LexicalAnalyzer * lex;
-	ofstream cpp;
+	OutputFile cpp;
+	bool inFunction;
+	bool streaming;		// each function holds its own symbols and constants
+	string function;
+	map <string, int> literalIds;
+	vector <string> literals;
+	Ring <string, 16> chunks;	// code for the writer; an empty chunk is the last
+	thread writer;
+	void Prologue (const string & name);
+	void WriteTables (ostream & out, const string & storage);
+	void Emit (string & code);
+	void Write ();
 };
 	
 #endif
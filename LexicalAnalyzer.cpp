@@ -0,0 +1,556 @@
+/*******************************************************************************
+* Title: Lexical Analyzer for Scheme to C++ Translator                         *
+* Author: Seth Nuzum                                                           *
+* Date: 11-17-23                                                               *
+* File: LexicalAnalyzer.cpp                                                    *
+*                                                                              *
+* Description: This file contains the implementation of the LexicalAnalyzer.  *
+*              Lexemes are recognized by a table driven DFA; identifiers are   *
+*              interned in a symbol table as they are scanned.                 *
+*******************************************************************************/
+
+#include <iomanip>
+#include <cstdlib>
+#include <cctype>
+#include "LexicalAnalyzer.h"
+
+using namespace std;
+
+bool pipelined = false;
+
+const string token_names[] = {
+	"{}", "IDKEY_T", "NUMLIT_T", "LISTOP1_T", "PLUS_T", "MINUS_T", "GT_T", "LT_T",
+	"TRUE_T", "FALSE_T", "DIV_T", "MULT_T", "EQUALTO_T", "GTE_T", "LTE_T",
+	"LPAREN_T", "RPAREN_T", "SQUOTE_T", "IDENT_T", "IF_T", "COND_T",
+	"DISPLAY_T", "NEWLINE_T", "AND_T", "OR_T", "NOT_T", "DEFINE_T", "LET_T", "LISTOP2_T",
+	"NUMBERP_T", "LISTP_T", "ZEROP_T", "NULLP_T", "EOFP_T", "MODULO_T", "ROUND_T",
+	"READ_T", "ELSE_T", "MAKEHASH_T", "HASHREF_T", "HASHSET_T", "HASHCOUNT_T",
+	"MAKEVECTOR_T", "VECTORREF_T", "VECTORSET_T", "VECTORLENGTH_T", "VECTOR_T",
+	"STRLIT_T", "ERROR_T", "EOF_T", "MAX_TOKENS"
+};
+
+/********************************************************************************/
+/* The DFA. char2col maps a character to its column in state_table; the       */
+/* columns are:                                                                 */
+/*   0 blank   1 "   2 #   3 '   4 (   5 )   6 *   7 +   8 -   9 .   10 /     */
+/*   11 <   12 =   13 >   14 ? or !   15 _   16 a   17 c   18 d   19 f   20 r */
+/*   21 t   22 other letters   23 digit   24 anything else                    */
+/* A positive entry is the next state. A negative entry ends the lexeme:      */
+/*   -1 keyword, operator or identifier     -2 numeric literal                */
+/*   -3 string literal                      -4 list operation (c[ad]+r)       */
+/*   -5 .. -9 invalid identifier, numeric literal, symbol, operator, string   */
+/*   -11 #( opening a vector literal                                           */
+/* The character that ends a lexeme of more than one character is given back, */
+/* except for the ( that ends #(.                                               */
+/* Only a string literal may run past the end of its line.                     */
+/********************************************************************************/
+static const int char2col [128] = {
+	24, 24, 24, 24, 24, 24, 24, 24, 24,  0,  0,  0,  0,  0, 24, 24,
+	24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+	 0, 14,  1,  2, 24, 24, 24,  3,  4,  5,  6,  7, 24,  8,  9, 10,
+	23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 24, 24, 11, 12, 13, 14,
+	24, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22,
+	22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 24, 24, 24, 24, 15,
+	24, 16, 22, 17, 18, 22, 19, 22, 22, 22, 22, 22, 22, 22, 22, 22,
+	22, 22, 20, 22, 21, 22, 22, 22, 22, 22, 22, 24, 24, 24, 24, 24
+};
+
+static const int state_table [][25] = {
+	/*  0 */ { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+	/*  1 start */
+		 { 0, 17,  8, -1, -1, -1,  9,  3,  3,  4,  9, 10,  9, 10, 21, 12, 12, 13, 12, 12, 12, 12, 12,  2, 21},
+	/*  2 integer */
+		 {-2, 20, 20, 20, -2, -2, 20, 20, 20,  5,  6, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,  2, 20},
+	/*  3 sign */
+		 {-1, 22, 22, 22, -1, -1, 22, 22, 22,  4, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22,  2, 22},
+	/*  4 point */
+		 {21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,  5, 21},
+	/*  5 real */
+		 {-2, 20, 20, 20, -2, -2, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,  5, 20},
+	/*  6 slash */
+		 {20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,  7, 20},
+	/*  7 rational */
+		 {-2, 20, 20, 20, -2, -2, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,  7, 20},
+	/*  8 # */
+		 {21, 21, 21, 21,-11, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 11, 21, 11, 21, 21, 21},
+	/*  9 operator */
+		 {-1, 22, 22, 22, -1, -1, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22},
+	/* 10 < or > */
+		 {-1, 22, 22, 22, -1, -1, 22, 22, 22, 22, 22, 22,  9, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22},
+	/* 11 #t or #f */
+		 {-1, 21, 21, 21, -1, -1, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21},
+	/* 12 identifier */
+		 {-1, 24, 24, 24, -1, -1, 24, 24, 12, 24, 24, 24, 24, 24, 16, 12, 12, 12, 12, 12, 12, 12, 12, 12, 24},
+	/* 13 c */
+		 {-1, 24, 24, 24, -1, -1, 24, 24, 12, 24, 24, 24, 24, 24, 16, 12, 14, 12, 14, 12, 12, 12, 12, 12, 24},
+	/* 14 c[ad]+ */
+		 {-1, 24, 24, 24, -1, -1, 24, 24, 12, 24, 24, 24, 24, 24, 16, 12, 14, 12, 14, 12, 15, 12, 12, 12, 24},
+	/* 15 c[ad]+r */
+		 {-4, 24, 24, 24, -4, -4, 24, 24, 12, 24, 24, 24, 24, 24, 16, 12, 12, 12, 12, 12, 12, 12, 12, 12, 24},
+	/* 16 predicate */
+		 {-1, 24, 24, 24, -1, -1, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24},
+	/* 17 in string */
+		 {17, 18, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17},
+	/* 18 string */
+		 {-3, 23, 23, 23, -3, -3, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23},
+	/* 19 */ { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+	/* 20 bad numeric literal */
+		 {-6, 20, 20, 20, -6, -6, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20},
+	/* 21 bad symbol */
+		 {-7, 21, 21, 21, -7, -7, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21},
+	/* 22 bad operator */
+		 {-8, 22, 22, 22, -8, -8, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22},
+	/* 23 bad string literal */
+		 {-9, 23, 23, 23, -9, -9, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23},
+	/* 24 bad identifier */
+		 {-5, 24, 24, 24, -5, -5, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24}
+};
+
+static const int IN_STRING = 17;
+static const int EOF_IN_STRING = -10;
+static const int VECTOR_START = -11;
+
+/********************************************************************************/
+/* This function returns the map from keywords and operators to their tokens. */
+/* It is built once and shared by every LexicalAnalyzer.                       */
+/********************************************************************************/
+static map <string, token_type> BuildKeywords ()
+{
+	map <string, token_type> keymap;
+	keymap["cons"] = LISTOP2_T;
+	keymap["list"] = LISTOP1_T;
+	keymap["append"] = LISTOP2_T;
+	keymap["if"] = IF_T;
+	keymap["cond"] = COND_T;
+	keymap["display"] = DISPLAY_T;
+	keymap["newline"] = NEWLINE_T;
+	keymap["and"] = AND_T;
+	keymap["or"] = OR_T;
+	keymap["not"] = NOT_T;
+	keymap["define"] = DEFINE_T;
+	keymap["let"] = LET_T;
+	keymap["number?"] = NUMBERP_T;
+	keymap["list?"] = LISTP_T;
+	keymap["zero?"] = ZEROP_T;
+	keymap["null?"] = NULLP_T;
+	keymap["eof?"] = EOFP_T;
+	keymap["modulo"] = MODULO_T;
+	keymap["round"] = ROUND_T;
+	keymap["read"] = READ_T;
+	keymap["else"] = ELSE_T;
+	keymap["make-hash-table"] = MAKEHASH_T;
+	keymap["hash-ref"] = HASHREF_T;
+	keymap["hash-set!"] = HASHSET_T;
+	keymap["hash-count"] = HASHCOUNT_T;
+	keymap["make-vector"] = MAKEVECTOR_T;
+	keymap["vector-ref"] = VECTORREF_T;
+	keymap["vector-set!"] = VECTORSET_T;
+	keymap["vector-length"] = VECTORLENGTH_T;
+	keymap["+"] = PLUS_T;
+	keymap["-"] = MINUS_T;
+	keymap["/"] = DIV_T;
+	keymap["*"] = MULT_T;
+	keymap["="] = EQUALTO_T;
+	keymap[">"] = GT_T;
+	keymap["<"] = LT_T;
+	keymap[">="] = GTE_T;
+	keymap["<="] = LTE_T;
+	keymap["("] = LPAREN_T;
+	keymap[")"] = RPAREN_T;
+	keymap["'"] = SQUOTE_T;
+	keymap["#t"] = TRUE_T;
+	keymap["#f"] = FALSE_T;
+	return keymap;
+}
+
+const map <string, token_type> & LexicalAnalyzer::Keywords ()
+{
+	static const map <string, token_type> keywords = BuildKeywords ();
+	return keywords;
+}
+
+/********************************************************************************/
+/* This function will initialize the LexicalAnalyzer object. It opens the      */
+/* input file and the .p1, .lst and .dbg output files. Messages for the user   */
+/* go to messages, cout unless another stream is given.                         */
+/********************************************************************************/
+LexicalAnalyzer::LexicalAnalyzer (const string & fileNamePrefix, ostream & messages)
+	: messages (messages), listingScan (&listingText), debugScan (&debugText), keymap (Keywords ())
+{
+	inputFile.open (fileNamePrefix + ".pl460");
+	input = &inputFile;
+	if (inputFile.fail ())
+	{
+		messages << "File " << fileNamePrefix << ".pl460 not found\n";
+		exit (2);
+	}
+	tokenFile.open (fileNamePrefix + ".p1");
+	listingFile.open (fileNamePrefix + ".lst");
+	listingFile << "Input file: " << fileNamePrefix << ".pl460" << endl;
+	debugFile.open (fileNamePrefix + ".dbg");
+	debugFile << "Input file: " << fileNamePrefix << ".pl460" << endl;
+	Start ();
+}
+
+/********************************************************************************/
+/* This constructor reads the program from in. No output files are opened, so  */
+/* what would be written to them is discarded; only the error count is kept.   */
+/********************************************************************************/
+LexicalAnalyzer::LexicalAnalyzer (istream & in, ostream & messages)
+	: messages (messages), listingScan (&listingText), debugScan (&debugText), keymap (Keywords ())
+{
+	input = &in;
+	Start ();
+}
+
+/********************************************************************************/
+/* This function sets up the scanner and the parser's state and, when          */
+/* pipelined, starts the thread that scans ahead. The scanner then writes the   */
+/* listing and debug text to the batches, and GetToken writes it to the files   */
+/* as it takes each token, so the files are the same as when the input is      */
+/* scanned a token at a time.                                                   */
+/********************************************************************************/
+void LexicalAnalyzer::Start ()
+{
+	line = " ";
+	linenum = 0;
+	pos = 0;
+	scanned = "";
+	scanErrors = 0;
+	listingOut = pipelined ? &listingScan : &listingFile;
+	debugOut = pipelined ? &debugScan : &debugFile;
+	lexeme = "";
+	tokenLine = 0;
+	tokenPos = 0;
+	errors = 0;
+	symbol = -1;
+	next = listingDone = debugDone = 0;
+	ended = false;
+	stopping = stopped = false;
+	if (pipelined)
+		scanner = thread (&LexicalAnalyzer::Scan, this);
+}
+
+/********************************************************************************/
+/* This function stops the scanner thread, taking and discarding what it has   */
+/* scanned until it sees that it is to stop.                                    */
+/********************************************************************************/
+void LexicalAnalyzer::Stop ()
+{
+	if (!scanner.joinable ())
+		return;
+	stopping = true;
+	while (!stopped)
+		if (!batches.Empty ())
+			batches.Pop ();
+		else
+			this_thread::yield ();
+	scanner.join ();
+}
+
+/********************************************************************************/
+/* This function will be called when the LexicalAnalyzer object is deleted. It */
+/* reports the number of errors found and closes the files.                    */
+/********************************************************************************/
+LexicalAnalyzer::~LexicalAnalyzer ()
+{
+	Stop ();
+	inputFile.close ();
+	errors += scanErrors;
+	messages << errors << " errors found in input file\n";
+	listingFile << errors << " errors found in input file\n";
+	listingFile.close ();
+	debugFile << errors << " errors found in input file\n";
+	debugFile.close ();
+}
+
+/********************************************************************************/
+/* This function returns the next token. When pipelined it is taken from the   */
+/* front batch, after the listing and debug text written before it; otherwise  */
+/* it is scanned now. Identifiers are interned, so GetSymbol gives the same    */
+/* number for every occurrence of a name.                                       */
+/********************************************************************************/
+token_type LexicalAnalyzer::GetToken ()
+{
+	Phase phase (LEX_P);
+	Phase::tokens++;
+	token_type token = EOF_T;
+	if (pipelined)
+	{
+		if (ended)
+			return EOF_T;
+		Batch & B = batches.Front ();
+		Token & T = B.tokens[next];
+		listingFile.write (B.listing.data () + listingDone, T.listingEnd - listingDone);
+		debugFile.write (B.debug.data () + debugDone, T.debugEnd - debugDone);
+		listingDone = T.listingEnd;
+		debugDone = T.debugEnd;
+		token = T.token;
+		if (!T.past)
+		{
+			lexeme.swap (T.lexeme);
+			tokenLine = T.linenum;
+			tokenPos = T.pos;
+		}
+		if (++next == B.count)
+		{
+			batches.Pop ();
+			next = listingDone = debugDone = 0;
+		}
+		ended = token == EOF_T;
+	}
+	else
+	{
+		if (input->fail ())
+			return EOF_T;
+		token = ScanToken ();
+		lexeme.swap (scanned);
+		tokenLine = linenum;
+		tokenPos = pos;
+	}
+	symbol = token == IDENT_T ? Intern (lexeme) : -1;
+	return token;
+}
+
+/********************************************************************************/
+/* This function runs on the scanner thread. It fills batches of BATCH tokens   */
+/* and publishes each one, until the end of the input or until it is stopped.   */
+/* A batch is published early when the next token is on a line that has not   */
+/* arrived, so that a program read from a pipe is translated as it comes.      */
+/********************************************************************************/
+static const size_t BATCH = 512;
+
+void LexicalAnalyzer::Scan ()
+{
+	for (bool more = true; more && !stopping; )
+	{
+		Batch & B = batches.Back ();
+		B.listing.clear ();
+		B.debug.clear ();
+		listingText.text = &B.listing;
+		debugText.text = &B.debug;
+		if (B.tokens.size () < BATCH)
+			B.tokens.resize (BATCH);
+		for (B.count = 0; B.count < BATCH && more && !(B.count && Waiting ()); B.count++)
+		{
+			Token & T = B.tokens[B.count];
+			T.past = input->fail ();
+			T.token = T.past ? EOF_T : ScanToken ();
+			T.lexeme.swap (scanned);
+			T.linenum = linenum;
+			T.pos = pos;
+			T.listingEnd = B.listing.size ();
+			T.debugEnd = B.debug.size ();
+			more = T.token != EOF_T;
+		}
+		batches.Push ();
+	}
+	stopped = true;
+}
+
+/********************************************************************************/
+/* This function tells whether scanning the next token would wait for input:  */
+/* the rest of the line is blank or a comment and nothing more has been read. */
+/********************************************************************************/
+bool LexicalAnalyzer::Waiting ()
+{
+	size_t next = line.find_first_not_of (" \t\n\v\f\r", pos);
+	return (next == string::npos || line[next] == ';') && input->rdbuf ()->in_avail () <= 0;
+}
+
+int LexicalAnalyzer::Text::overflow (int c)
+{
+	if (c != EOF)
+		text->push_back (c);
+	return c == EOF ? 0 : c;
+}
+
+streamsize LexicalAnalyzer::Text::xsputn (const char * s, streamsize n)
+{
+	text->append (s, n);
+	return n;
+}
+
+/********************************************************************************/
+/* This function scans the next lexeme from the input file and returns its     */
+/* token. Blanks and comments are skipped first; then the DFA is run until it  */
+/* reaches an ending state.                                                     */
+/********************************************************************************/
+token_type LexicalAnalyzer::ScanToken ()
+{
+	scanned = "";
+	int state = 1;
+	token_type token = NONE;
+	while (isspace (line[pos]) || line[pos] == ';')
+	{
+		pos++;
+		if (size_t (pos) >= line.length () || line[pos - 1] == ';')
+			if (!GetALine ())
+				return EOF_T;
+	}
+	while (state > 0)
+	{
+		char c = line[pos++];
+		scanned += c;
+		int col = unsigned (c) <= 127 ? char2col[int (c)] : 24;
+		state = state_table[state][col];
+		if (state == IN_STRING && size_t (pos) >= line.length ())
+		{
+			if (GetALine ())
+				scanned += '\n';
+			else
+				state = EOF_IN_STRING;
+		}
+		else if (state > 0 && size_t (pos) >= line.length ())
+			state = state_table[state][0];
+	}
+	if (scanned.length () > 1 && state != VECTOR_START)
+	{
+		pos--;
+		scanned.pop_back ();
+	}
+	switch (state)
+	{
+		case -1:
+		{
+			map <string, token_type>::const_iterator K = keymap.find (scanned);
+			if (K != keymap.end ())
+				token = K->second;
+			else
+			{
+				token = IDENT_T;
+			}
+			break;
+		}
+		case -2:
+			token = NUMLIT_T;
+			break;
+		case -3:
+			token = STRLIT_T;
+			break;
+		case -4:
+			token = LISTOP1_T;
+			break;
+		case VECTOR_START:
+			token = VECTOR_T;
+			break;
+		case -5:
+			ScanError ("Invalid identifier '" + scanned + "' found");
+			token = ERROR_T;
+			break;
+		case -6:
+			ScanError ("Invalid numeric literal '" + scanned + "' found");
+			token = ERROR_T;
+			break;
+		case -7:
+			ScanError ("Invalid symbol '" + scanned + "' found");
+			token = ERROR_T;
+			break;
+		case -8:
+			ScanError ("Invalid operator '" + scanned + "' found");
+			token = ERROR_T;
+			break;
+		case -9:
+			ScanError ("Invalid string literal '" + scanned + "' found");
+			token = ERROR_T;
+			break;
+		case EOF_IN_STRING:
+			ScanError ("End of file found in string literal '" + scanned);
+			token = ERROR_T;
+			break;
+		default:
+			ScanError ("Stray '" + scanned + "' found");
+			token = ERROR_T;
+			break;
+	}
+	*debugOut << '\t' << setw (16) << left << token_names[token] << scanned << endl;
+	tokenFile << '\t' << setw (16) << left << token_names[token] << scanned << endl;
+	return token;
+}
+
+/********************************************************************************/
+/* This function returns the name of token t.                                   */
+/********************************************************************************/
+string LexicalAnalyzer::GetTokenName (token_type t) const
+{
+	return token_names[t];
+}
+
+/********************************************************************************/
+/* This function returns the lexeme of the last token returned by GetToken.    */
+/********************************************************************************/
+string LexicalAnalyzer::GetLexeme () const
+{
+	return lexeme;
+}
+
+/********************************************************************************/
+/* Symbols. Each identifier name is stored once, in order of first appearance; */
+/* an identifier token carries the index of its name, so identifiers compare   */
+/* equal exactly when their indices do.                                         */
+/********************************************************************************/
+int LexicalAnalyzer::Intern (const string & name)
+{
+	pair <unordered_map <string, int>::iterator, bool> S = symbolIds.emplace (name, int (symbols.size ()));
+	if (S.second)
+		symbols.push_back (name);
+	return S.first->second;
+}
+
+int LexicalAnalyzer::GetSymbol () const
+{
+	return symbol;
+}
+
+const vector <string> & LexicalAnalyzer::GetSymbols () const
+{
+	return symbols;
+}
+
+// Starts a new table, numbering names from 0 again
+void LexicalAnalyzer::ForgetSymbols ()
+{
+	symbolIds.clear ();
+	symbols.clear ();
+}
+
+/********************************************************************************/
+/* These functions write an error message to the listing and debug files, at   */
+/* the end of the last token returned, for the parser, or at the scanner's     */
+/* position, for the scanner.                                                   */
+/********************************************************************************/
+void LexicalAnalyzer::ReportError (const string & msg)
+{
+	listingFile << "Error at " << tokenLine << ',' << tokenPos << ": " << msg << endl;
+	debugFile << "Error at " << tokenLine << ',' << tokenPos << ": " << msg << endl;
+	errors++;
+}
+
+void LexicalAnalyzer::ScanError (const string & msg)
+{
+	*listingOut << "Error at " << linenum << ',' << pos << ": " << msg << endl;
+	*debugOut << "Error at " << linenum << ',' << pos << ": " << msg << endl;
+	scanErrors++;
+}
+
+/********************************************************************************/
+/* This function reads the next line of the input file and echoes it to the    */
+/* listing and debug files. A blank is added to the end of the line so that    */
+/* the last lexeme on it is always followed by one.                             */
+/********************************************************************************/
+bool LexicalAnalyzer::GetALine ()
+{
+	getline (*input, line);
+	if (input->fail ())
+	{
+		*debugOut << '\t' << setw (16) << left << "EOF_T" << endl;
+		tokenFile << '\t' << setw (16) << left << "EOF_T" << endl;
+		return false;
+	}
+	linenum++;
+	*listingOut << setw (4) << right << linenum << ": " << line << endl;
+	*debugOut << setw (4) << right << linenum << ": " << line << endl;
+	line += ' ';
+	pos = 0;
+	return true;
+}
@@ -13,6 +13,11 @@
 #include <iostream>
 #include <fstream>
 #include <map>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Phases.h"
+#include "Ring.h"
 
 using namespace std;
 
@@ -30,10 +35,12 @@ enum token_type
 	LPAREN_T, RPAREN_T, SQUOTE_T, IDENT_T, IF_T, COND_T,
 	DISPLAY_T, NEWLINE_T, AND_T, OR_T, NOT_T, DEFINE_T, LET_T, LISTOP2_T,
 	NUMBERP_T, LISTP_T, ZEROP_T, NULLP_T, EOFP_T, MODULO_T, ROUND_T,
-	READ_T, ELSE_T, STRLIT_T, ERROR_T, EOF_T, MAX_TOKENS
+	READ_T, ELSE_T, MAKEHASH_T, HASHREF_T, HASHSET_T, HASHCOUNT_T,
+	MAKEVECTOR_T, VECTORREF_T, VECTORSET_T, VECTORLENGTH_T, VECTOR_T,
+	STRLIT_T, ERROR_T, EOF_T, MAX_TOKENS
 };
 
-extern string token_names[];
+extern const string token_names[];
 
 /*******************************************************************************
 * Class: LexicalAnalyzer                                                       *
@@ -41,29 +48,96 @@ extern string token_names[];
 * Description: This class is designed to read a Scheme program, recognize      *
 *              lexemes, and generate tokens.                                   *
 *              The class will also produce a listing with error messages.      *
+*              When pipelined, the input is scanned on a thread of its own,    *
+*              ahead of the parser, and GetToken takes the tokens in order     *
+*              from a Ring of batches.                                         *
 *******************************************************************************/
 
 class LexicalAnalyzer 
 {
     public:
-	LexicalAnalyzer (const string & fileNamePrefix);
+	LexicalAnalyzer (const string & fileNamePrefix, ostream & messages = cout);
+	LexicalAnalyzer (istream & in, ostream & messages);
 	~LexicalAnalyzer ();
 	token_type GetToken ();
 	string GetTokenName (token_type t) const;
 	string GetLexeme () const;
+	int GetSymbol () const;
+	int Intern (const string & name);
+	const vector <string> & GetSymbols () const;
+	void ForgetSymbols ();
 	void ReportError (const string & msg);
-	ofstream debugFile;	// .dbg
+	OutputFile debugFile;	// .dbg
     private:
+	// A scanned token, with where the scan ended and the ends of the listing
+	// and debug text written up to it
+	struct Token
+	{
+		token_type token;
+		string lexeme;
+		int linenum;
+		int pos;
+		size_t listingEnd;
+		size_t debugEnd;
+		bool past;		// taken after the end of the input; nothing was scanned
+	};
+	struct Batch
+	{
+		vector <Token> tokens;
+		size_t count;
+		string listing;
+		string debug;
+	};
+	// An output stream's buffer that appends to the text of the batch being filled
+	class Text : public streambuf
+	{
+	    public:
+		string * text;
+	    protected:
+		int overflow (int c) override;
+		streamsize xsputn (const char * s, streamsize n) override;
+	};
+
+	ostream & messages;	// the error count and a missing input file are reported here
 	ifstream inputFile; 	// .ss 
-	ofstream listingFile;	// .lst
-	ofstream tokenFile;	// .p1
+	istream * input;	// inputFile, or the stream being translated
+	OutputFile listingFile;	// .lst
+	OutputFile tokenFile;	// .p1
+	// The scanner's state
 	string line;
 	int linenum;
 	int pos;
+	string scanned;		// the lexeme being scanned
+	int scanErrors;
+	Text listingText, debugText;
+	ostream listingScan, debugScan;
+	ostream * listingOut;	// the scanner's listing and debug output: the files, or
+	ostream * debugOut;	// the batch being filled when pipelined
+	// The parser's state
 	string lexeme;
+	int tokenLine;
+	int tokenPos;
 	int errors;
-	map <string, token_type> keymap;
+	const map <string, token_type> & keymap;	// shared by every LexicalAnalyzer
+	int symbol;				// index of the current identifier's name, or -1
+	unordered_map <string, int> symbolIds;
+	vector <string> symbols;		// identifier names in order of first appearance
+	// The pipeline
+	Ring <Batch, 8> batches;
+	thread scanner;
+	size_t next;		// the next token of the front batch
+	size_t listingDone;	// the text of the front batch written so far
+	size_t debugDone;
+	bool ended;		// the EOF_T token has been taken
+	atomic <bool> stopping, stopped;
+	void Start ();
+	void Stop ();
+	void Scan ();
+	bool Waiting ();
+	token_type ScanToken ();
+	void ScanError (const string & msg);
 	bool GetALine ();
+	static const map <string, token_type> & Keywords ();
 };
 	
 #endif
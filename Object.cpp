@@ -0,0 +1,3403 @@
+/*******************************************************************************
+* Title: Object runtime for Scheme to C++ Translator                           *
+* Author: Seth Nuzum                                                           *
+* Date: 11-17-23                                                               *
+* File: Object.cpp                                                             *
+*                                                                              *
+* Description: This file contains the implementation of the Object, rational  *
+*              and boolean classes used by the generated C++ programs.         *
+*******************************************************************************/
+
+#include <cstdlib>
+#include <climits>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <cctype>
+#include <chrono>
+#include <array>
+#include <utility>
+#include <unordered_map>
+#include <charconv>
+#include <cerrno>
+#include <mutex>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Object.h"
+
+using namespace std;
+
+// Indexed by obj_type; getType reports a bigint as an integer, the counters apart
+static const int TYPES = VECTOR + 1;
+static const char * typeNames [TYPES] = {"unknown", "integer", "real", "string", "rational", "boolean", "list", "bigint", "symbol", "hash table", "vector"};
+
+/********************************************************************************/
+/* Runtime counters. Each thread counts into its own counters, which are added */
+/* to the totals when the thread exits; the main thread's are added at program */
+/* exit. When PL460_STATS is set the totals are then printed on cerr, as JSON   */
+/* if it is "json" and as a table otherwise. The counters are plain data: a    */
+/* thread_local with a destructor would cost a call on every increment, so a   */
+/* thread instead registers its counters with a pthread key the first time it  */
+/* counts, and the key's destructor adds them to the totals.                    */
+/********************************************************************************/
+enum Operation {OP_PLUS, OP_MINUS, OP_TIMES, OP_DIVIDE, OP_MODULO, OP_EQUAL, OP_NOT_EQUAL,
+	OP_LESS, OP_LESS_EQUAL, OP_GREATER, OP_GREATER_EQUAL, OP_NOT, OP_ROUND, OPERATIONS};
+enum ListOperation {LIST_CAR, LIST_CDR, LIST_CXR, LIST_LIST, LIST_CONS, LIST_APPEND, LIST_OPERATIONS};
+
+static const char * operationNames [OPERATIONS] = {"+", "-", "*", "/", "%", "==", "!=", "<", "<=", ">", ">=", "!", "round"};
+static const char * listOperationNames [LIST_OPERATIONS] = {"car", "cdr", "c[ad]+r", "list", "cons", "append"};
+
+struct Counts
+{
+	bool registered;
+	unsigned long long constructed [TYPES];
+	unsigned long long copies;
+	unsigned long long elementCopies;	// list elements copied by append
+	unsigned long long strings;			// string cells allocated
+	unsigned long long operations [OPERATIONS];
+	unsigned long long listOperations [LIST_OPERATIONS];
+};
+
+static struct
+{
+	mutex lock;
+	Counts counts;
+} totals;
+
+static thread_local Counts counters;
+
+static void AddCounts (void * C)
+{
+	lock_guard <mutex> hold (totals.lock);
+	const unsigned long long * from = static_cast <Counts *> (C)->constructed;
+	unsigned long long * to = totals.counts.constructed;
+	for (size_t i = 0; i < (sizeof (Counts) - offsetof (Counts, constructed)) / sizeof (unsigned long long); i++)
+		to[i] += from[i];
+}
+
+static void RegisterCounts ()
+{
+	static pthread_key_t key = [] { pthread_key_t K; pthread_key_create (&K, AddCounts); return K; } ();
+	counters.registered = true;
+	pthread_setspecific (key, &counters);
+}
+
+static inline Counts & Count ()
+{
+	if (__builtin_expect (!counters.registered, 0))
+		RegisterCounts ();
+	return counters;
+}
+
+static void PrintCounts (ostream & outs, const Counts & C, bool json)
+{
+	const char * separator = "";
+	auto group = [&] (const char * name, const char * const * names, const unsigned long long * values, int n)
+	{
+		if (json)
+			outs << "  \"" << name << "\": {";
+		for (int i = 0, first = 1; i < n; i++)
+			if (json)
+			{
+				outs << (first ? "" : ", ") << '"' << names[i] << "\": " << values[i];
+				first = 0;
+			}
+			else if (values[i])
+				outs << "  " << name << ' ' << names[i] << string (24 - min (strlen (name) + strlen (names[i]), size_t (23)), ' ') << values[i] << '\n';
+		if (json)
+			outs << "},\n";
+	};
+	auto single = [&] (const char * name, unsigned long long value)
+	{
+		if (json)
+			outs << separator << "  \"" << name << "\": " << value;
+		else
+			outs << "  " << name << string (25 - strlen (name), ' ') << value << '\n';
+		separator = ",\n";
+	};
+	outs << (json ? "{\n" : "PL460 runtime counters\n");
+	group ("constructed", typeNames, C.constructed, TYPES);
+	group ("operator", operationNames, C.operations, OPERATIONS);
+	group ("listop", listOperationNames, C.listOperations, LIST_OPERATIONS);
+	single ("copies", C.copies);
+	single ("list element copies", C.elementCopies);
+	single ("string allocations", C.strings);
+	outs << (json ? "\n}\n" : "");
+}
+
+static struct StatsReport
+{
+	const char * format = getenv ("PL460_STATS");
+	~StatsReport ()
+	{
+		if (!format)
+			return;
+		if (counters.registered)	// the main thread's key destructor does not run at exit
+			AddCounts (&counters);
+		PrintCounts (cerr, totals.counts, strcmp (format, "json") == 0);
+	}
+} statsReport;
+
+/********************************************************************************/
+/* Heap cells holding the payloads that do not fit in an Object. A cell is      */
+/* shared by every copy of an Object and deleted when the last copy goes away.  */
+/* Cells record their type so the collector can walk the heap, and whether     */
+/* they have survived a collection (old) or are still in the nursery.          */
+/********************************************************************************/
+struct ObjectCell
+{
+	ObjectCell (obj_type K) : refs (1), kind (K), old (false) {}
+	static void * operator new (size_t size);
+	static void operator delete (void * p, size_t size);
+	int refs;
+	unsigned char kind;
+	bool old;
+};
+
+struct StringCell : ObjectCell
+{
+	StringCell (const string & S) : ObjectCell (STRING), value (S) { Count ().strings++; }
+	string value;
+};
+
+struct RationalCell : ObjectCell
+{
+	RationalCell (const rational & R) : ObjectCell (RATIONAL), value (R) {}
+	rational value;
+};
+
+struct BigCell : ObjectCell
+{
+	BigCell (const bigint & B) : ObjectCell (BIGINT), value (B) {}
+	bigint value;
+};
+
+/********************************************************************************/
+/* A list is a chain of pairs ending in the empty list, which has no cell.      */
+/* Pairs are never modified once built, so any number of lists may share a      */
+/* tail: cdr and cons are O(1) and append copies only its first list.           */
+/********************************************************************************/
+struct PairCell : ObjectCell
+{
+	PairCell (Object A, Object D) : ObjectCell (LIST), car (move (A)), cdr (move (D)) {}
+	Object car;
+	Object cdr;
+};
+
+/********************************************************************************/
+/* A hash table is an open addressing table probed linearly. Each slot keeps    */
+/* its key's hash; a slot whose key has no type is empty. Unlike pairs, tables  */
+/* are modified in place, so they can hold references to themselves.           */
+/********************************************************************************/
+struct HashSlot
+{
+	size_t hash;
+	Object key;
+	Object value;
+};
+
+struct HashCell : ObjectCell
+{
+	HashCell () : ObjectCell (HASH), count (0), slots (8) {}
+	size_t count;
+	vector <HashSlot> slots;	// the number of slots is a power of 2
+};
+
+struct VectorCell : ObjectCell
+{
+	VectorCell (size_t length, const Object & X) : ObjectCell (VECTOR), items (length, X) {}
+	vector <Object> items;
+};
+
+static inline bool OnHeap (obj_type T)
+{
+	return T == STRING || T == RATIONAL || T == LIST || T == BIGINT || T == HASH || T == VECTOR;
+}
+
+static inline const string & StrOf (const ObjectCell * C)
+{
+	return static_cast <const StringCell *> (C)->value;
+}
+
+static inline const rational & RatOf (const ObjectCell * C)
+{
+	return static_cast <const RationalCell *> (C)->value;
+}
+
+static inline const bigint & BigOf (const ObjectCell * C)
+{
+	return static_cast <const BigCell *> (C)->value;
+}
+
+static inline PairCell * PairOf (ObjectCell * C)
+{
+	return static_cast <PairCell *> (C);
+}
+
+static inline HashCell * TableOf (ObjectCell * C)
+{
+	return static_cast <HashCell *> (C);
+}
+
+static inline VectorCell * VectorOf (ObjectCell * C)
+{
+	return static_cast <VectorCell *> (C);
+}
+
+/********************************************************************************/
+/* This function calls visit on each Object held by the cell C, including the  */
+/* untyped Objects of empty hash table slots.                                   */
+/********************************************************************************/
+template <class F> static inline void ForChildren (ObjectCell * C, F visit)
+{
+	if (C->kind == LIST)
+	{
+		visit (PairOf (C)->car);
+		visit (PairOf (C)->cdr);
+	}
+	else if (C->kind == HASH)
+		for (HashSlot & S : TableOf (C)->slots)
+		{
+			visit (S.key);
+			visit (S.value);
+		}
+	else if (C->kind == VECTOR)
+		for (Object & X : VectorOf (C)->items)
+			visit (X);
+}
+
+/********************************************************************************/
+/* Symbol table. Each symbol name is stored once and a symbol Object holds the  */
+/* index of its name, so two symbols are equal exactly when their indices are.  */
+/* The table is built on first use, so symbols may be made by the static       */
+/* initializers of generated programs.                                          */
+/********************************************************************************/
+struct SymbolTable
+{
+	unordered_map <string, long long> ids;
+	vector <const string *> names;
+};
+
+static SymbolTable & Symbols ()
+{
+	static SymbolTable table;
+	return table;
+}
+
+static inline const string & NameOf (long long id)
+{
+	return *Symbols ().names[id];
+}
+
+/********************************************************************************/
+/* Cell heap. Cells are carved by a bump pointer out of 64 KB chunks that each  */
+/* hold one size class; freed cells go on a free list for their class. The     */
+/* heap is sized from the environment the first time a cell is allocated:       */
+/*   PL460_NURSERY   bytes allocated between collections (default 4 MB)         */
+/*   PL460_HEAP      heap size that makes a collection a full one (64 MB)       */
+/*   PL460_GC_STATS  when set, collection statistics are printed at exit        */
+/********************************************************************************/
+static const size_t CHUNK_SIZE = 65536;
+static const int SIZE_CLASSES = 8;
+
+struct Chunk
+{
+	Chunk * next;
+	bool arena;		// the chunk belongs to the region arena
+	size_t slot;
+	size_t used;
+	size_t count;
+	size_t young;
+	int * gcrefs;
+	char * first;
+};
+
+struct FreeSlot
+{
+	char header [sizeof (ObjectCell)];
+	FreeSlot * next;
+};
+
+static struct
+{
+	bool configured;
+	bool collecting;
+	Chunk * chunks [SIZE_CLASSES];
+	FreeSlot * free [SIZE_CLASSES];
+	size_t nurseryLimit;
+	size_t heapLimit;
+	size_t heapBytes;
+	size_t peakBytes;
+	size_t sinceCollection;
+	unsigned long long allocated;
+	unsigned long long cells;
+	unsigned long long reclaimed;
+	unsigned long minor;
+	unsigned long major;
+	double pauseTotal;
+	double pauseMax;
+	Region * region;			// the innermost open region
+	Chunk * arena [SIZE_CLASSES];		// region chunks, the one being carved first
+	Chunk * spare;				// emptied region chunks, for reuse
+	unsigned long regionsReset;
+	unsigned long regionsPromoted;
+} heap;
+
+static size_t EnvSize (const char * name, size_t fallback)
+{
+	const char * value = getenv (name);
+	return value && atol (value) > 0 ? size_t (atol (value)) : fallback;
+}
+
+static void ConfigureHeap ()
+{
+	heap.configured = true;
+	heap.nurseryLimit = EnvSize ("PL460_NURSERY", 4 << 20);
+	heap.heapLimit = EnvSize ("PL460_HEAP", 64 << 20);
+	if (getenv ("PL460_GC_STATS"))
+		atexit ([] { gc_stats (cerr); });
+}
+
+static inline Chunk * ChunkOf (const ObjectCell * C)
+{
+	return (Chunk *) (uintptr_t (C) & ~(CHUNK_SIZE - 1));
+}
+
+static inline int & GCRefs (const ObjectCell * C)
+{
+	Chunk * K = ChunkOf (C);
+	return K->gcrefs[((const char *) C - K->first) / K->slot];
+}
+
+static Chunk * NewChunk (int sc)
+{
+	Chunk * K = heap.spare;
+	if (K)
+		heap.spare = K->next;
+	else if (!(K = (Chunk *) aligned_alloc (CHUNK_SIZE, CHUNK_SIZE)))
+		throw bad_alloc ();
+	K->next = NULL;
+	K->arena = false;
+	K->slot = (sc + 1) * 16;
+	K->used = 0;
+	K->first = (char *) K + ((sizeof (Chunk) + 15) & ~size_t (15));
+	K->count = (CHUNK_SIZE - (K->first - (char *) K)) / K->slot;
+	K->young = 0;
+	K->gcrefs = NULL;
+	return K;
+}
+
+void * ObjectCell::operator new (size_t size)
+{
+	if (!heap.configured)
+		ConfigureHeap ();
+	int sc = int ((size + 15) / 16) - 1;
+	heap.allocated += size;
+	heap.cells++;
+	if (heap.sinceCollection >= heap.nurseryLimit && !heap.collecting)
+		Object::Collect (heap.heapBytes >= heap.heapLimit);
+	heap.sinceCollection += size;
+	void * p;
+	if (heap.region && !heap.free[sc])
+		p = Region::Allocate (sc);
+	else
+	{
+		if (heap.free[sc])
+		{
+			p = heap.free[sc];
+			heap.free[sc] = heap.free[sc]->next;
+		}
+		else
+		{
+			Chunk * K = heap.chunks[sc];
+			if (!K || K->used == K->count)
+			{
+				K = NewChunk (sc);
+				K->next = heap.chunks[sc];
+				heap.chunks[sc] = K;
+				heap.heapBytes += CHUNK_SIZE;
+				heap.peakBytes = max (heap.peakBytes, heap.heapBytes);
+			}
+			p = K->first + K->used++ * K->slot;
+		}
+	}
+	static_cast <ObjectCell *> (p)->kind = NONE;
+	static_cast <ObjectCell *> (p)->old = false;
+	ChunkOf (static_cast <ObjectCell *> (p))->young++;
+	return p;
+}
+
+void ObjectCell::operator delete (void * p, size_t size)
+{
+	int sc = int ((size + 15) / 16) - 1;
+	Chunk * K = ChunkOf (static_cast <ObjectCell *> (p));
+	if (!static_cast <ObjectCell *> (p)->old)
+		K->young--;
+	static_cast <ObjectCell *> (p)->kind = NONE;
+	if (K->arena)
+		return;
+	FreeSlot * F = static_cast <FreeSlot *> (p);
+	F->next = heap.free[sc];
+	heap.free[sc] = F;
+}
+
+/********************************************************************************/
+/* Regions. While a Region is open, the cells allocated are carved with a bump  */
+/* pointer out of the heap's one arena, and a cell freed there is only marked   */
+/* free. A Region marks where the arena stands when it opens; nested regions    */
+/* carve on from the mark of the one outside them, so the chunks in use follow  */
+/* the cells alive, not the depth of the calls. When a Region closes with none  */
+/* of the cells past its mark alive, the arena is released back to the mark at */
+/* once. Otherwise some cell escaped the activation, and the cells are left to  */
+/* the enclosing region; when the outermost one closes, the arena chunks are    */
+/* promoted to the general heap: their free slots go on the free lists and the  */
+/* collector takes over their live cells. Cells never move, so an escape costs  */
+/* only the promotion. A region takes cells from the free lists while they are  */
+/* not empty, so promoted chunks are filled before new ones are carved.         */
+/* Collections run while regions are open; arena cells are roots to them and   */
+/* are not examined.                                                            */
+/********************************************************************************/
+Region::Region ()
+{
+	outer = heap.region;
+	for (int sc = 0; sc < SIZE_CLASSES; sc++)
+	{
+		mark[sc] = heap.arena[sc];
+		used[sc] = mark[sc] ? mark[sc]->used : 0;
+	}
+	heap.region = this;
+}
+
+Region::~Region ()
+{
+	heap.region = outer;
+	bool reset = true;
+	for (int sc = 0; sc < SIZE_CLASSES && reset; sc++)
+		for (Chunk * K = heap.arena[sc]; reset && K != mark[sc]; K = K->next)
+			reset = Dead (K, 0);
+	for (int sc = 0; sc < SIZE_CLASSES && reset; sc++)
+		if (mark[sc])
+			reset = Dead (mark[sc], used[sc]);
+	(reset ? heap.regionsReset : heap.regionsPromoted)++;
+	if (!reset && outer)
+		return;
+	for (int sc = 0; sc < SIZE_CLASSES; sc++)
+	{
+		while (heap.arena[sc] != (reset ? mark[sc] : NULL))
+		{
+			Chunk * K = heap.arena[sc];
+			heap.arena[sc] = K->next;
+			if (reset)
+			{
+				K->next = heap.spare;
+				heap.spare = K;
+			}
+			else
+				Promote (K, sc);
+		}
+		if (reset && mark[sc])
+			mark[sc]->used = used[sc];
+	}
+}
+
+bool Region::Dead (Chunk * K, size_t from)
+{
+	for (size_t i = from; i < K->used; i++)
+		if (((ObjectCell *) (K->first + i * K->slot))->kind != NONE)
+			return false;
+	return true;
+}
+
+void * Region::Allocate (int sc)
+{
+	Chunk * K = heap.arena[sc];
+	if (!K || K->used == K->count)
+	{
+		K = NewChunk (sc);
+		K->arena = true;
+		K->next = heap.arena[sc];
+		heap.arena[sc] = K;
+	}
+	return K->first + K->used++ * K->slot;
+}
+
+void Region::Promote (Chunk * K, int sc)
+{
+	K->arena = false;
+	for (size_t i = 0; i < K->count; i++)
+	{
+		ObjectCell * C = (ObjectCell *) (K->first + i * K->slot);
+		if (i >= K->used)
+			C->kind = NONE;
+		if (C->kind == NONE)
+		{
+			FreeSlot * F = (FreeSlot *) C;
+			F->next = heap.free[sc];
+			heap.free[sc] = F;
+		}
+	}
+	K->used = K->count;
+	// Behind the chunk the general heap is carving, so that one keeps its space
+	Chunk * head = heap.chunks[sc];
+	if (head)
+	{
+		K->next = head->next;
+		head->next = K;
+	}
+	else
+	{
+		K->next = NULL;
+		heap.chunks[sc] = K;
+	}
+	heap.heapBytes += CHUNK_SIZE;
+	heap.peakBytes = max (heap.peakBytes, heap.heapBytes);
+}
+
+/********************************************************************************/
+/* Error reporting used by the operators. Each reports the offending values and */
+/* their types and terminates the generated program.                            */
+/********************************************************************************/
+static void TypeError (const char * op, const Object & L, const Object & R)
+{
+	cerr << "Wrong types for " << op << " operator: " << L << " and " << R
+	     << " (" << L.getType() << " and " << R.getType() << ")" << endl;
+	exit (1);
+}
+
+static void TypeError (const char * what, const Object & O)
+{
+	cerr << "Wrong type for " << what << ": " << O << " (" << O.getType() << ")" << endl;
+	exit (1);
+}
+
+static void ZeroDivisor (const char * op, const Object & L, const Object & R)
+{
+	cerr << "Division by zero: " << L << ' ' << op << ' ' << R << endl;
+	exit (1);
+}
+
+/********************************************************************************/
+/* bigint. Values that fit in a long long take the fast paths below, using the  */
+/* compiler's overflow checked arithmetic; a result that overflows is redone on */
+/* magnitudes, vectors of base 2^32 digits kept least significant first with   */
+/* no leading zeros.                                                            */
+/********************************************************************************/
+static void Trim (vector <unsigned> & M)
+{
+	while (!M.empty () && M.back () == 0)
+		M.pop_back ();
+}
+
+static vector <unsigned> FromU64 (unsigned long long V)
+{
+	vector <unsigned> M;
+	for (; V; V >>= 32)
+		M.push_back (unsigned (V));
+	return M;
+}
+
+static int CompareMag (const vector <unsigned> & A, const vector <unsigned> & B)
+{
+	if (A.size () != B.size ())
+		return A.size () < B.size () ? -1 : 1;
+	for (size_t i = A.size (); i-- > 0; )
+		if (A[i] != B[i])
+			return A[i] < B[i] ? -1 : 1;
+	return 0;
+}
+
+static vector <unsigned> AddMag (const vector <unsigned> & A, const vector <unsigned> & B)
+{
+	const vector <unsigned> & L = A.size () >= B.size () ? A : B;
+	const vector <unsigned> & S = A.size () >= B.size () ? B : A;
+	vector <unsigned> R (L.size () + 1);
+	unsigned long long carry = 0;
+	for (size_t i = 0; i < L.size (); i++)
+	{
+		carry += (unsigned long long) L[i] + (i < S.size () ? S[i] : 0);
+		R[i] = unsigned (carry);
+		carry >>= 32;
+	}
+	R[L.size ()] = unsigned (carry);
+	Trim (R);
+	return R;
+}
+
+// A - B, where A >= B
+static vector <unsigned> SubMag (const vector <unsigned> & A, const vector <unsigned> & B)
+{
+	vector <unsigned> R (A.size ());
+	long long borrow = 0;
+	for (size_t i = 0; i < A.size (); i++)
+	{
+		long long D = (long long) A[i] - (i < B.size () ? B[i] : 0) - borrow;
+		borrow = D < 0;
+		R[i] = unsigned (D + (borrow << 32));
+	}
+	Trim (R);
+	return R;
+}
+
+static vector <unsigned> MulMag (const vector <unsigned> & A, const vector <unsigned> & B)
+{
+	if (A.empty () || B.empty ())
+		return vector <unsigned> ();
+	vector <unsigned> R (A.size () + B.size ());
+	for (size_t i = 0; i < A.size (); i++)
+	{
+		unsigned long long carry = 0;
+		for (size_t j = 0; j < B.size (); j++)
+		{
+			carry += (unsigned long long) A[i] * B[j] + R[i + j];
+			R[i + j] = unsigned (carry);
+			carry >>= 32;
+		}
+		R[i + B.size ()] = unsigned (carry);
+	}
+	Trim (R);
+	return R;
+}
+
+// Q = A / D; returns A % D
+static unsigned DivSmall (const vector <unsigned> & A, unsigned D, vector <unsigned> & Q)
+{
+	Q.assign (A.size (), 0);
+	unsigned long long R = 0;
+	for (size_t i = A.size (); i-- > 0; )
+	{
+		R = (R << 32) | A[i];
+		Q[i] = unsigned (R / D);
+		R %= D;
+	}
+	Trim (Q);
+	return unsigned (R);
+}
+
+/********************************************************************************/
+/* Long division of magnitudes (Knuth, TAOCP vol. 2, algorithm D): Q = A / B    */
+/* and R = A % B.                                                               */
+/********************************************************************************/
+static void DivMag (const vector <unsigned> & A, const vector <unsigned> & B,
+		vector <unsigned> & Q, vector <unsigned> & R)
+{
+	if (CompareMag (A, B) < 0)
+	{
+		Q.clear ();
+		R = A;
+		return;
+	}
+	if (B.size () == 1)
+	{
+		unsigned rest = DivSmall (A, B[0], Q);
+		R = FromU64 (rest);
+		return;
+	}
+	int s = __builtin_clz (B.back ());
+	size_t n = B.size (), m = A.size () - n;
+	vector <unsigned> U (A.size () + 1), V (n);
+	for (size_t i = 0; i < A.size (); i++)
+	{
+		U[i] |= A[i] << s;
+		U[i + 1] = s ? A[i] >> (32 - s) : 0;
+	}
+	for (size_t i = 0; i < n; i++)
+		V[i] = (B[i] << s) | (s && i ? B[i - 1] >> (32 - s) : 0);
+	Q.assign (m + 1, 0);
+	for (size_t j = m + 1; j-- > 0; )
+	{
+		unsigned long long top = ((unsigned long long) U[j + n] << 32) | U[j + n - 1];
+		unsigned long long qhat = top / V[n - 1], rhat = top % V[n - 1];
+		while (qhat >> 32 || qhat * V[n - 2] > ((rhat << 32) | U[j + n - 2]))
+		{
+			qhat--;
+			rhat += V[n - 1];
+			if (rhat >> 32)
+				break;
+		}
+		long long borrow = 0, T;
+		unsigned long long carry = 0;
+		for (size_t i = 0; i < n; i++)
+		{
+			unsigned long long P = qhat * V[i] + carry;
+			carry = P >> 32;
+			T = (long long) U[i + j] - borrow - (long long) (P & 0xffffffff);
+			U[i + j] = unsigned (T);
+			borrow = T < 0;
+		}
+		T = (long long) U[j + n] - borrow - (long long) carry;
+		U[j + n] = unsigned (T);
+		if (T < 0)
+		{
+			qhat--;
+			carry = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				carry += (unsigned long long) U[i + j] + V[i];
+				U[i + j] = unsigned (carry);
+				carry >>= 32;
+			}
+			U[j + n] += unsigned (carry);
+		}
+		Q[j] = unsigned (qhat);
+	}
+	Trim (Q);
+	R.assign (n, 0);
+	for (size_t i = 0; i < n; i++)
+		R[i] = (U[i] >> s) | (s ? U[i + 1] << (32 - s) : 0);
+	Trim (R);
+}
+
+bigint::bigint ()
+{
+	fixnum = 0;
+	minus = false;
+}
+
+bigint::bigint (const long long I)
+{
+	fixnum = I;
+	minus = false;
+}
+
+bigint::bigint (const double D)
+{
+	fixnum = 0;
+	minus = false;
+	if (fabs (D) < 9223372036854775808.0)	// 2^63; below it the value is a fixnum
+		fixnum = (long long) D;
+	else if (isfinite (D))
+	{
+		int E;
+		unsigned long long M = (unsigned long long) ldexp (frexp (fabs (D), &E), 64);
+		vector <unsigned> R (size_t (E - 64) / 32, 0);
+		vector <unsigned> top = FromU64 (M);
+		R.insert (R.end (), top.begin (), top.end ());
+		*this = bigint (D < 0, R) * bigint (1LL << ((E - 64) % 32));
+	}
+}
+
+bigint::bigint (const string & S)
+{
+	fixnum = 0;
+	minus = false;
+	size_t start = (!S.empty () && (S[0] == '+' || S[0] == '-')) ? 1 : 0;
+	if (S.size () - start <= 18)
+	{
+		fixnum = strtoll (S.c_str (), NULL, 10);
+		return;
+	}
+	vector <unsigned> M;
+	for (size_t i = start; i < S.size (); )
+	{
+		size_t len = min (S.size () - i, size_t (9));
+		unsigned long long carry = strtoull (S.substr (i, len).c_str (), NULL, 10);
+		unsigned long long scale = 1;
+		for (size_t k = 0; k < len; k++)
+			scale *= 10;
+		for (size_t k = 0; k < M.size (); k++)
+		{
+			carry += M[k] * scale;
+			M[k] = unsigned (carry);
+			carry >>= 32;
+		}
+		if (carry)
+			M.push_back (unsigned (carry));
+		i += len;
+	}
+	*this = bigint (S[0] == '-', M);
+}
+
+/********************************************************************************/
+/* This constructor takes a sign and magnitude, and stores the value directly   */
+/* when it fits in a long long.                                                 */
+/********************************************************************************/
+bigint::bigint (bool negative, vector <unsigned> & magnitude)
+{
+	Trim (magnitude);
+	fixnum = 0;
+	minus = false;
+	if (magnitude.size () <= 2)
+	{
+		unsigned long long V = magnitude.empty () ? 0 : magnitude[0];
+		if (magnitude.size () == 2)
+			V |= (unsigned long long) magnitude[1] << 32;
+		if (V <= (unsigned long long) LLONG_MAX)
+		{
+			fixnum = negative ? -(long long) V : (long long) V;
+			return;
+		}
+		if (negative && V == 1ULL << 63)
+		{
+			fixnum = LLONG_MIN;
+			return;
+		}
+	}
+	minus = negative;
+	digits.swap (magnitude);
+}
+
+vector <unsigned> bigint::magnitude () const
+{
+	if (!digits.empty ())
+		return digits;
+	return FromU64 (fixnum < 0 ? 0 - (unsigned long long) fixnum : fixnum);
+}
+
+bool bigint::negative () const
+{
+	return digits.empty () ? fixnum < 0 : minus;
+}
+
+ostream & operator << (ostream & output, const bigint & B)
+{
+	if (B.digits.empty ())
+		return output << B.fixnum;
+	return output << to_string (B);
+}
+
+string to_string (const bigint & B)
+{
+	if (B.digits.empty ())
+		return to_string (B.fixnum);
+	vector <unsigned> M = B.digits, Q;
+	vector <unsigned> groups;
+	while (!M.empty ())
+	{
+		groups.push_back (DivSmall (M, 1000000000, Q));
+		M.swap (Q);
+	}
+	string S = B.minus ? "-" : "";
+	S += to_string (groups.back ());
+	for (size_t i = groups.size () - 1; i-- > 0; )
+	{
+		string G = to_string (groups[i]);
+		S += string (9 - G.size (), '0') + G;
+	}
+	return S;
+}
+
+bool bigint::operator != (const bigint & B) const
+{
+	return !(*this == B);
+}
+
+bool bigint::operator > (const bigint & B) const
+{
+	return B < *this;
+}
+
+bool bigint::operator >= (const bigint & B) const
+{
+	return !(*this < B);
+}
+
+bool bigint::operator == (const bigint & B) const
+{
+	if (digits.empty () || B.digits.empty ())
+		return digits.empty () && B.digits.empty () && fixnum == B.fixnum;
+	return minus == B.minus && digits == B.digits;
+}
+
+bool bigint::operator < (const bigint & B) const
+{
+	if (digits.empty () && B.digits.empty ())
+		return fixnum < B.fixnum;
+	if (negative () != B.negative ())
+		return negative ();
+	int C = CompareMag (magnitude (), B.magnitude ());
+	return negative () ? C > 0 : C < 0;
+}
+
+bool bigint::operator <= (const bigint & B) const
+{
+	return !(B < *this);
+}
+
+bigint bigint::operator + (const bigint & B) const
+{
+	long long R;
+	if (digits.empty () && B.digits.empty () && !__builtin_add_overflow (fixnum, B.fixnum, &R))
+		return bigint (R);
+	vector <unsigned> L = magnitude (), M = B.magnitude ();
+	if (negative () == B.negative ())
+	{
+		M = AddMag (L, M);
+		return bigint (negative (), M);
+	}
+	if (CompareMag (L, M) >= 0)
+	{
+		M = SubMag (L, M);
+		return bigint (negative (), M);
+	}
+	M = SubMag (M, L);
+	return bigint (B.negative (), M);
+}
+
+bigint bigint::operator - (const bigint & B) const
+{
+	long long R;
+	if (digits.empty () && B.digits.empty () && !__builtin_sub_overflow (fixnum, B.fixnum, &R))
+		return bigint (R);
+	return *this + -B;
+}
+
+bigint bigint::operator * (const bigint & B) const
+{
+	long long R;
+	if (digits.empty () && B.digits.empty () && !__builtin_mul_overflow (fixnum, B.fixnum, &R))
+		return bigint (R);
+	vector <unsigned> M = MulMag (magnitude (), B.magnitude ());
+	return bigint (negative () != B.negative (), M);
+}
+
+bigint bigint::DivMod (const bigint & A, const bigint & B, bool remainder)
+{
+	if (B.sign () == 0)
+	{
+		cerr << "Denominator cannot be 0; exiting program." << endl;
+		exit (1);
+	}
+	if (A.digits.empty () && B.digits.empty () && !(A.fixnum == LLONG_MIN && B.fixnum == -1))
+		return bigint (remainder ? A.fixnum % B.fixnum : A.fixnum / B.fixnum);
+	vector <unsigned> Q, R;
+	DivMag (A.magnitude (), B.magnitude (), Q, R);
+	if (remainder)
+		return bigint (A.negative (), R);
+	return bigint (A.negative () != B.negative (), Q);
+}
+
+bigint bigint::operator / (const bigint & B) const
+{
+	return DivMod (*this, B, false);
+}
+
+bigint bigint::operator % (const bigint & B) const
+{
+	return DivMod (*this, B, true);
+}
+
+bigint bigint::operator - () const
+{
+	if (digits.empty () && fixnum != LLONG_MIN)
+		return bigint (-fixnum);
+	vector <unsigned> M = magnitude ();
+	return bigint (!negative (), M);
+}
+
+bigint::operator double () const
+{
+	if (digits.empty ())
+		return double (fixnum);
+	double D = 0;
+	for (size_t i = digits.size (); i-- > 0; )
+		D = D * 4294967296.0 + digits[i];
+	return minus ? -D : D;
+}
+
+bool bigint::fits () const
+{
+	return digits.empty ();
+}
+
+long long bigint::value () const
+{
+	return fixnum;
+}
+
+int bigint::sign () const
+{
+	if (digits.empty ())
+		return (fixnum > 0) - (fixnum < 0);
+	return minus ? -1 : 1;
+}
+
+/********************************************************************************/
+/* The greatest common divisor is found by Euclid's algorithm while either      */
+/* value is large, then by the binary algorithm once both fit in 64 bits.      */
+/********************************************************************************/
+bigint gcd (const bigint & A, const bigint & B)
+{
+	bigint X = A.sign () < 0 ? -A : A;
+	bigint Y = B.sign () < 0 ? -B : B;
+	while (!X.digits.empty () || !Y.digits.empty ())
+	{
+		if (Y.sign () == 0)
+			return X;
+		bigint T = X % Y;
+		X = Y;
+		Y = T;
+	}
+	unsigned long long U = X.fixnum, V = Y.fixnum;
+	if (U == 0 || V == 0)
+		return bigint ((long long) (U | V));
+	int shift = __builtin_ctzll (U | V);
+	U >>= __builtin_ctzll (U);
+	while (V)
+	{
+		V >>= __builtin_ctzll (V);
+		if (U > V)
+			swap (U, V);
+		V -= U;
+	}
+	return bigint ((long long) (U << shift));
+}
+
+/********************************************************************************/
+/* rational. Arithmetic leaves its results unreduced while the numerator and    */
+/* denominator stay within 32 bits, where the next operation cannot overflow   */
+/* the 64 bit fast path. A rational with a larger term is always kept in       */
+/* lowest terms, which lets + and * on them use Knuth's formulas: these take   */
+/* the gcd of a large term and a small one wherever they can, rather than of    */
+/* the two large terms of the result. Values are reduced when they are output  */
+/* or their terms are asked for.                                                */
+/********************************************************************************/
+static inline bool Narrow (const bigint & B)
+{
+	return B.fits () && B.value () >= INT_MIN && B.value () <= INT_MAX;
+}
+
+rational::rational ()
+{
+	num = 0LL;
+	denom = 1LL;
+}
+
+rational::rational (const rational & R)
+{
+	num = R.num;
+	denom = R.denom;
+}
+
+rational::~rational ()
+{
+}
+
+rational & rational::operator = (const rational & R)
+{
+	num = R.num;
+	denom = R.denom;
+	return *this;
+}
+
+istream & operator >> (istream & input, rational & R)
+{
+	long long N, D = 1;
+	input >> N;
+	if (input.peek() == '/')
+	{
+		input.get();
+		input >> D;
+	}
+	R = rational (bigint (N), bigint (D));
+	return input;
+}
+
+ostream & operator << (ostream & output, const rational & R)
+{
+	rational T = R;
+	T.reduce ();
+	output << T.num;
+	if (T.denom != 1LL)
+		output << '/' << T.denom;
+	return output;
+}
+
+rational::rational (const int numerator, const int denominator)
+{
+	*this = rational (bigint ((long long) numerator), bigint ((long long) denominator));
+}
+
+rational::rational (const int I)
+{
+	num = (long long) I;
+	denom = 1LL;
+}
+
+rational::rational (const double D)
+{
+	num = bigint (std::round (D * 100000));
+	denom = 100000LL;
+	reduce ();
+}
+
+rational::rational (const bigint & I)
+{
+	num = I;
+	denom = 1LL;
+}
+
+rational::rational (const bigint & numerator, const bigint & denominator)
+{
+	if (denominator.sign () == 0)
+	{
+		cerr << "Denominator cannot be 0; exiting program." << endl;
+		exit (1);
+	}
+	num = numerator;
+	denom = denominator;
+	reduce ();
+}
+
+bool rational::operator != (const rational & R) const
+{
+	return !(*this == R);
+}
+
+bool rational::operator > (const rational & R) const
+{
+	return R < *this;
+}
+
+bool rational::operator >= (const rational & R) const
+{
+	return !(*this < R);
+}
+
+bool rational::operator == (const rational & R) const
+{
+	if (denom == R.denom)
+		return num == R.num;
+	return num * R.denom == R.num * denom;
+}
+
+bool rational::operator < (const rational & R) const
+{
+	if (denom == R.denom)
+		return num < R.num;
+	return num * R.denom < R.num * denom;
+}
+
+bool rational::operator <= (const rational & R) const
+{
+	return !(R < *this);
+}
+
+rational rational::operator + (const rational & R) const
+{
+	rational S;
+	if (denom == R.denom)
+	{
+		S.num = num + R.num;
+		S.denom = denom;
+		S.settle ();
+		return S;
+	}
+	if (Narrow (num) && Narrow (denom) && Narrow (R.num) && Narrow (R.denom))
+	{
+		S.num = num * R.denom + R.num * denom;
+		S.denom = denom * R.denom;
+		S.settle ();
+		return S;
+	}
+	rational A = *this, B = R;
+	A.lowest ();
+	B.lowest ();
+	bigint G = gcd (A.denom, B.denom);
+	if (G == 1LL)
+	{
+		S.num = A.num * B.denom + B.num * A.denom;
+		S.denom = A.denom * B.denom;
+		return S;
+	}
+	bigint T = A.num * (B.denom / G) + B.num * (A.denom / G);
+	bigint H = gcd (T, G);
+	S.num = T / H;
+	S.denom = (A.denom / G) * (B.denom / H);
+	return S;
+}
+
+rational rational::operator / (const rational & R) const
+{
+	return *this * R.reciprocal ();
+}
+
+rational rational::operator - (const rational & R) const
+{
+	rational N = R;
+	N.num = -N.num;
+	return *this + N;
+}
+
+rational rational::operator * (const rational & R) const
+{
+	rational S;
+	if (Narrow (num) && Narrow (denom) && Narrow (R.num) && Narrow (R.denom))
+	{
+		S.num = num * R.num;
+		S.denom = denom * R.denom;
+		S.settle ();
+		return S;
+	}
+	rational A = *this, B = R;
+	A.lowest ();
+	B.lowest ();
+	bigint G = gcd (A.num, B.denom), H = gcd (B.num, A.denom);
+	S.num = (A.num / G) * (B.num / H);
+	S.denom = (A.denom / H) * (B.denom / G);
+	return S;
+}
+
+rational rational::operator *= (const rational & R)
+{
+	return *this = *this * R;
+}
+
+rational rational::operator += (const rational & R)
+{
+	return *this = *this + R;
+}
+
+rational rational::operator -= (const rational & R)
+{
+	return *this = *this - R;
+}
+
+rational rational::operator /= (const rational & R)
+{
+	return *this = *this / R;
+}
+
+rational rational::operator ++ ()
+{
+	num = num + denom;
+	return *this;
+}
+
+rational rational::operator ++ (int)
+{
+	rational old = *this;
+	num = num + denom;
+	return old;
+}
+
+rational rational::operator -- ()
+{
+	num = num - denom;
+	return *this;
+}
+
+rational rational::operator -- (int)
+{
+	rational old = *this;
+	num = num - denom;
+	return old;
+}
+
+rational::operator int () const
+{
+	return int ((num / denom).value ());
+}
+
+rational::operator float () const
+{
+	return float (double (*this));
+}
+
+rational::operator double () const
+{
+	if (num.fits () && denom.fits ())
+		return double (num.value ()) / double (denom.value ());
+	rational T = *this;
+	T.reduce ();
+	return double (T.num) / double (T.denom);
+}
+
+string to_string (const rational & R)
+{
+	rational T = R;
+	T.reduce ();
+	string S = to_string (T.num);
+	if (T.denom != 1LL)
+		S += '/' + to_string (T.denom);
+	return S;
+}
+
+/********************************************************************************/
+/* Rounding is half away from zero.                                            */
+/********************************************************************************/
+rational rational::round ()
+{
+	bigint twice = denom * bigint (2LL);
+	num = (num * bigint (2LL) + (num.sign () < 0 ? -denom : denom)) / twice;
+	denom = 1LL;
+	return *this;
+}
+
+rational rational::round (unsigned D)
+{
+	bigint scale = 1LL;
+	while (D--)
+		scale = scale * bigint (10LL);
+	rational scaled;
+	scaled.num = num * scale;
+	scaled.denom = denom;
+	scaled.round ();
+	return *this = rational (scaled.num, scale);
+}
+
+int round (const rational & R)
+{
+	rational T = R;
+	return int (T.round ().num.value ());
+}
+
+rational round (const rational & R, unsigned D)
+{
+	rational T = R;
+	return T.round (D);
+}
+
+rational rational::reduce ()
+{
+	if (denom.sign () < 0)
+	{
+		num = -num;
+		denom = -denom;
+	}
+	bigint G = gcd (num, denom);
+	if (G != 1LL)
+	{
+		num = num / G;
+		denom = denom / G;
+	}
+	return *this;
+}
+
+rational rational::reciprocal () const
+{
+	if (num.sign () == 0)
+	{
+		cerr << "Denominator cannot be 0; exiting program." << endl;
+		exit (1);
+	}
+	rational R;
+	R.num = num.sign () < 0 ? -denom : denom;
+	R.denom = num.sign () < 0 ? -num : num;
+	return R;
+}
+
+bigint rational::numerator () const
+{
+	rational T = *this;
+	return T.reduce ().num;
+}
+
+bigint rational::denominator () const
+{
+	rational T = *this;
+	return T.reduce ().denom;
+}
+
+/********************************************************************************/
+/* This function makes the denominator positive, and reduces the fraction once */
+/* either term has grown past 32 bits.                                         */
+/********************************************************************************/
+void rational::settle ()
+{
+	if (denom.sign () < 0)
+	{
+		num = -num;
+		denom = -denom;
+	}
+	if (!Narrow (num) || !Narrow (denom))
+		reduce ();
+}
+
+/********************************************************************************/
+/* This function puts a rational in lowest terms; one with a term past 32 bits  */
+/* is already.                                                                  */
+/********************************************************************************/
+void rational::lowest ()
+{
+	if (Narrow (num) && Narrow (denom))
+		reduce ();
+}
+
+/********************************************************************************/
+/* boolean                                                                      */
+/********************************************************************************/
+boolean::boolean ()
+{
+	value = false;
+}
+
+boolean::boolean (const int B)
+{
+	value = B != 0;
+}
+
+boolean::operator bool () const
+{
+	return value;
+}
+
+ostream & operator << (ostream & output, const boolean & B)
+{
+	output << (B.value ? "#t" : "#f");
+	return output;
+}
+
+/********************************************************************************/
+/* Object construction, copying and destruction.                                */
+/********************************************************************************/
+Object::Object ()
+{
+	type = NONE;
+	cell = NULL;
+	Count ().constructed[NONE]++;
+}
+
+Object::Object (const int & value)
+{
+	type = INT;
+	intval = value;
+	Count ().constructed[INT]++;
+}
+
+Object::Object (const long long & value)
+{
+	type = INT;
+	intval = value;
+	Count ().constructed[INT]++;
+}
+
+/********************************************************************************/
+/* An integer is stored in place when it fits in 64 bits and in a cell         */
+/* otherwise, so an INT and a BIGINT never hold the same value.                 */
+/********************************************************************************/
+Object::Object (const bigint & value)
+{
+	if (value.fits ())
+	{
+		type = INT;
+		intval = value.value ();
+	}
+	else
+	{
+		type = BIGINT;
+		cell = new BigCell (value);
+	}
+	Count ().constructed[type]++;
+}
+
+Object::Object (const double & value)
+{
+	type = REAL;
+	realval = value;
+	Count ().constructed[REAL]++;
+}
+
+Object::Object (const rational & value)
+{
+	type = RATIONAL;
+	cell = new RationalCell (value);
+	Count ().constructed[RATIONAL]++;
+}
+
+Object::Object (const boolean & value)
+{
+	type = BOOLEAN;
+	boolval = value;
+	Count ().constructed[BOOLEAN]++;
+}
+
+Object::Object (const Object & O)
+{
+	type = O.type;
+	cell = O.cell;
+	if (OnHeap (type) && cell)
+		cell->refs++;
+	Count ().copies++;
+}
+
+Object::Object (Object && O) noexcept
+{
+	type = O.type;
+	cell = O.cell;
+	O.type = NONE;
+}
+
+Object::~Object ()
+{
+	Release ();
+}
+
+Object & Object::operator = (const Object & O)
+{
+	if (OnHeap (O.type) && O.cell)
+		O.cell->refs++;
+	Release ();
+	type = O.type;
+	cell = O.cell;
+	Count ().copies++;
+	return *this;
+}
+
+Object & Object::operator = (Object && O) noexcept
+{
+	if (this != &O)
+	{
+		Release ();
+		type = O.type;
+		cell = O.cell;
+		O.type = NONE;
+	}
+	return *this;
+}
+
+/********************************************************************************/
+/* This function drops this Object's reference to its heap cell, deleting the   */
+/* cell when no other Object shares it. A list's pairs are freed in a loop so   */
+/* that releasing a long list does not recurse once per element.                */
+/********************************************************************************/
+void Object::Release ()
+{
+	if (!OnHeap (type) || !cell || --cell->refs > 0)
+		return;
+	if (type == STRING)
+		delete static_cast <StringCell *> (cell);
+	else if (type == RATIONAL)
+		delete static_cast <RationalCell *> (cell);
+	else if (type == BIGINT)
+		delete static_cast <BigCell *> (cell);
+	else if (type == HASH)
+		delete TableOf (cell);
+	else if (type == VECTOR)
+		delete VectorOf (cell);
+	else
+	{
+		PairCell * P = PairOf (cell);
+		while (P)
+		{
+			ObjectCell * next = P->cdr.cell;
+			P->cdr.type = NONE;
+			delete P;
+			P = next && --next->refs == 0 ? PairOf (next) : NULL;
+		}
+	}
+}
+
+Object::Object (obj_type T, ObjectCell * C)
+{
+	type = T;
+	cell = C;
+	Count ().constructed[T]++;
+}
+
+/********************************************************************************/
+/* The text accepted by Object (const string &) is classified as an integer,    */
+/* real, rational, boolean, list or vector literal; anything else is kept as a  */
+/* string.                                                                      */
+/********************************************************************************/
+static bool IsDigits (const string & S, size_t from, size_t to)
+{
+	if (from >= to)
+		return false;
+	for (size_t i = from; i < to; i++)
+		if (!isdigit ((unsigned char) S[i]))
+			return false;
+	return true;
+}
+
+static obj_type Classify (const string & S)
+{
+	if (S.empty ())
+		return STRING;
+	if (S[0] == '(')
+		return LIST;
+	if (S.compare (0, 2, "#(") == 0)
+		return VECTOR;
+	if (S == "#t" || S == "#f")
+		return BOOLEAN;
+	size_t start = (S[0] == '+' || S[0] == '-') ? 1 : 0;
+	size_t dot = S.find ('.');
+	size_t slash = S.find ('/');
+	if (dot == string::npos && slash == string::npos)
+		return IsDigits (S, start, S.size ()) ? INT : STRING;
+	if (slash == string::npos)
+	{
+		if (S.find ('.', dot + 1) != string::npos)
+			return STRING;
+		bool left = dot == start || IsDigits (S, start, dot);
+		bool right = dot + 1 == S.size () || IsDigits (S, dot + 1, S.size ());
+		return left && right && S.size () - start > 1 ? REAL : STRING;
+	}
+	if (dot == string::npos && IsDigits (S, start, slash) && IsDigits (S, slash + 1, S.size ()))
+		return RATIONAL;
+	return STRING;
+}
+
+/********************************************************************************/
+/* This function returns the length of the list element starting at S[pos]:    */
+/* a parenthesized sublist or vector, a string literal, or a run of non-blank  */
+/* characters.                                                                  */
+/********************************************************************************/
+static size_t ElementLength (const string & S, size_t pos)
+{
+	size_t i = pos;
+	if (S[i] == '\'' || S.compare (i, 2, "#(") == 0)
+		i++;
+	if (i < S.size () && S[i] == '(')
+	{
+		int depth = 0;
+		bool quoted = false;
+		for (; i < S.size (); i++)
+		{
+			if (quoted)
+			{
+				if (S[i] == '\\')
+					i++;
+				else if (S[i] == '"')
+					quoted = false;
+			}
+			else if (S[i] == '"')
+				quoted = true;
+			else if (S[i] == '(')
+				depth++;
+			else if (S[i] == ')' && --depth == 0)
+				return i + 1 - pos;
+		}
+		return S.size () - pos;
+	}
+	if (i < S.size () && S[i] == '"')
+	{
+		for (i++; i < S.size () && S[i] != '"'; i++)
+			if (S[i] == '\\')
+				i++;
+		return min (i + 1, S.size ()) - pos;
+	}
+	while (i < S.size () && !isspace ((unsigned char) S[i]) && S[i] != '(' && S[i] != ')')
+		i++;
+	return i - pos;
+}
+
+Object::Object (const string & value)
+{
+	type = Classify (value);
+	if (type == INT)
+		*this = Object (bigint (value));
+	else if (type == REAL)
+		realval = strtod (value.c_str (), NULL);
+	else if (type == BOOLEAN)
+		boolval = value[1] == 't';
+	else if (type == RATIONAL)
+	{
+		size_t slash = value.find ('/');
+		bigint N (value.substr (0, slash));
+		bigint D (value.substr (slash + 1));
+		cell = new RationalCell (rational (N, D));
+	}
+	else if (type == LIST)
+	{
+		cell = NULL;
+		Object * tail = this;
+		size_t pos = 1;
+		while (pos < value.size ())
+		{
+			if (isspace ((unsigned char) value[pos]))
+				pos++;
+			else if (value[pos] == ')')
+				break;
+			else
+			{
+				size_t len = ElementLength (value, pos);
+				tail->cell = new PairCell (Element (value.substr (pos, len)), Object (LIST, NULL));
+				tail = &PairOf (tail->cell)->cdr;
+				pos += len;
+			}
+		}
+	}
+	else if (type == VECTOR)
+	{
+		VectorCell * V = new VectorCell (0, Object ());
+		cell = V;
+		size_t pos = 2;
+		while (pos < value.size ())
+		{
+			if (isspace ((unsigned char) value[pos]))
+				pos++;
+			else if (value[pos] == ')')
+				break;
+			else
+			{
+				size_t len = ElementLength (value, pos);
+				V->items.push_back (Element (value.substr (pos, len)));
+				pos += len;
+			}
+		}
+	}
+	else
+		cell = new StringCell (value);
+	if (type != INT)	// an integer was counted by Object (bigint)
+		Count ().constructed[type]++;
+}
+
+/********************************************************************************/
+/* This function returns the symbol with the given name, adding the name to    */
+/* the symbol table the first time it is seen.                                  */
+/********************************************************************************/
+Object symbol (const string & name)
+{
+	SymbolTable & S = Symbols ();
+	pair <unordered_map <string, long long>::iterator, bool> I = S.ids.emplace (name, S.names.size ());
+	if (I.second)
+		S.names.push_back (&I.first->first);
+	Object O;
+	O.type = SYMBOL;
+	O.symval = I.first->second;
+	return O;
+}
+
+/********************************************************************************/
+/* This function makes a list element from its text. A bare name in a list    */
+/* literal is a symbol; string literals keep their quotes.                      */
+/********************************************************************************/
+Object Object::Element (const string & text)
+{
+	if (text[0] != '"' && text[0] != '\'' && Classify (text) == STRING)
+		return symbol (text);
+	return Object (text);
+}
+
+/********************************************************************************/
+/* The reader parses data straight from its input with no intermediate copy.   */
+/* Standard input is memory mapped when it is a regular file and otherwise     */
+/* read in large blocks; once read has taken standard input it should be the   */
+/* only reader of it. Any other stream is read through its streambuf, so it is */
+/* never consumed past the end of the datum.                                   */
+/********************************************************************************/
+static void FlushOutput ();
+
+struct StdinSource
+{
+	const char * pos = NULL;
+	const char * end = NULL;
+	bool mapped = false;
+	int peek () { return pos < end || Fill () ? (unsigned char) *pos : EOF; }
+	int get () { return pos < end || Fill () ? (unsigned char) *pos++ : EOF; }
+	bool Fill ();
+};
+
+bool StdinSource::Fill ()
+{
+	static char block [1 << 16];
+	if (mapped)
+		return false;
+	struct stat info;
+	if (end == NULL && fstat (0, &info) == 0 && S_ISREG (info.st_mode))
+	{
+		off_t offset = lseek (0, 0, SEEK_CUR);
+		if (offset >= 0 && offset < info.st_size)
+		{
+			void * map = mmap (NULL, info.st_size, PROT_READ, MAP_PRIVATE, 0, 0);
+			if (map != MAP_FAILED)
+			{
+				madvise (map, info.st_size, MADV_SEQUENTIAL);
+				pos = (const char *) map + offset;
+				end = (const char *) map + info.st_size;
+				mapped = true;
+				return true;
+			}
+		}
+	}
+	ssize_t n;
+	FlushOutput ();
+	while ((n = ::read (0, block, sizeof block)) < 0 && errno == EINTR)
+		;
+	pos = block;
+	end = block + max (n, ssize_t (0));
+	return n > 0;
+}
+
+struct StreamSource
+{
+	streambuf * buf;
+	int peek () { return buf->sgetc (); }
+	int get () { return buf->sbumpc (); }
+};
+
+static StdinSource Stdin;
+static streambuf * const StdinBuffer = cin.rdbuf ();
+
+struct Reader
+{
+	template <class Source> static int SkipSpace (Source & in);
+	template <class Source> static Object Datum (Source & in, bool element);
+	static Object Atom (const string & text);
+};
+
+template <class Source>
+int Reader::SkipSpace (Source & in)
+{
+	int c;
+	while ((c = in.peek ()) != EOF && isspace (c))
+		in.get ();
+	return c;
+}
+
+/********************************************************************************/
+/* This function reads one datum: a list, a vector, a string literal, a quoted */
+/* datum, or an atom. A string read on its own has its quotes dropped; a list element    */
+/* keeps them, as list literals do.                                             */
+/********************************************************************************/
+template <class Source>
+Object Reader::Datum (Source & in, bool element)
+{
+	int c = SkipSpace (in);
+	if (c == EOF)
+		return Object (string ("#<eof>"));
+	if (c == '(')
+	{
+		in.get ();
+		Object list (LIST, NULL);
+		Object * tail = &list;
+		while ((c = SkipSpace (in)) != ')' && c != EOF)
+		{
+			tail->cell = new PairCell (Datum (in, true), Object (LIST, NULL));
+			tail = &PairOf (tail->cell)->cdr;
+		}
+		in.get ();
+		return list;
+	}
+	if (c == ')')
+	{
+		in.get ();
+		return Object (string ());
+	}
+	if (c == '\'')
+	{
+		in.get ();
+		Object quoted = Datum (in, false);
+		return Object (LIST, new PairCell (symbol ("quote"), Object (LIST, new PairCell (move (quoted), Object (LIST, NULL)))));
+	}
+	string text;
+	if (c == '#')
+	{
+		in.get ();
+		if (in.peek () == '(')
+		{
+			in.get ();
+			VectorCell * V = new VectorCell (0, Object ());
+			Object vector (VECTOR, V);
+			while ((c = SkipSpace (in)) != ')' && c != EOF)
+				V->items.push_back (Datum (in, true));
+			in.get ();
+			return vector;
+		}
+		text += '#';
+	}
+	else if (c == '"')
+	{
+		in.get ();
+		if (element)
+			text += '"';
+		while ((c = in.get ()) != EOF && c != '"')
+		{
+			if (c == '\\' && in.peek () != EOF)
+				c = in.get ();
+			text += char (c);
+		}
+		if (element)
+			text += '"';
+		return Object (STRING, new StringCell (text));
+	}
+	while ((c = in.peek ()) != EOF && !isspace (c) && c != '(' && c != ')')
+		text += char (in.get ());
+	return Atom (text);
+}
+
+/********************************************************************************/
+/* This function parses an atom. Numbers are converted with from_chars and     */
+/* fall back to bigints when they do not fit; anything else is a boolean or a  */
+/* symbol.                                                                      */
+/********************************************************************************/
+static inline const char * SkipDigits (const char * p, const char * last)
+{
+	while (p < last && isdigit ((unsigned char) *p))
+		p++;
+	return p;
+}
+
+Object Reader::Atom (const string & text)
+{
+	const char * first = text.data ();
+	const char * last = first + text.size ();
+	const char * digits = first + (first < last && (*first == '+' || *first == '-'));
+	const char * from = first + (first < last && *first == '+');
+	const char * p = SkipDigits (digits, last);
+	if (p == last && p > digits)
+	{
+		long long value;
+		if (from_chars (from, last, value).ec == errc ())
+			return Object (value);
+		return Object (bigint (text));
+	}
+	if (p < last && *p == '.' && SkipDigits (p + 1, last) == last && last - digits > 1)
+	{
+		double value;
+		if (from_chars (from, last, value).ec == errc ())
+			return Object (value);
+	}
+	if (p < last && *p == '/' && p > digits && SkipDigits (p + 1, last) == last && p + 1 < last)
+	{
+		long long N, D;
+		if (from_chars (from, p, N).ec == errc () && from_chars (p + 1, last, D).ec == errc ())
+			return Object (rational (bigint (N), bigint (D)));
+	}
+	return Object::Element (text);
+}
+
+/********************************************************************************/
+/* Numeric helpers. Mixed arithmetic promotes integer to rational to real.      */
+/* Integer arithmetic is done in 64 bits with overflow checks, and redone on   */
+/* bigints when it overflows.                                                   */
+/********************************************************************************/
+static constexpr bool IsNumber (obj_type T)
+{
+	return T == INT || T == REAL || T == RATIONAL || T == BIGINT;
+}
+
+static constexpr bool IsInteger (obj_type T)
+{
+	return T == INT || T == BIGINT;
+}
+
+static inline rational RationalOf (obj_type T, long long I, const ObjectCell * C)
+{
+	if (T == RATIONAL)
+		return RatOf (C);
+	if (T == BIGINT)
+		return rational (BigOf (C));
+	return rational (bigint (I));
+}
+
+#define RAT_OF(O) RationalOf ((O).type, (O).intval, (O).cell)
+
+/********************************************************************************/
+/* Operator dispatch. Each binary operator has a table, built at compile time,  */
+/* holding the function that implements it for every (left type, right type)   */
+/* pair; a pair the operator is not defined on holds one reporting the error.  */
+/* The operators handle INT x INT and REAL x REAL inline and index their table */
+/* for everything else.                                                         */
+/********************************************************************************/
+typedef Object (*Arithmetic) (const Object & L, const Object & R);
+typedef bool (*Equality) (const Object & L, const Object & R);
+typedef int (*Ordering) (const Object & L, const Object & R);
+template <class F> using Table = array <array <F, TYPES>, TYPES>;
+
+/********************************************************************************/
+/* The arithmetic operators. integral marks an operator defined only on        */
+/* integers and joins one that also appends strings and lists; Defined checks  */
+/* the right operand of a numeric pair.                                         */
+/********************************************************************************/
+struct Plus
+{
+	static constexpr const char * name = "+";
+	static constexpr bool integral = false, joins = true;
+	static bool Defined (const Object &) { return true; }
+	static bool Fixnum (long long A, long long B, long long & R) { return !__builtin_add_overflow (A, B, &R); }
+	static Object Exact (const bigint & A, const bigint & B) { return Object (A + B); }
+	static Object Exact (const rational & A, const rational & B) { return Object (A + B); }
+	static double Inexact (double A, double B) { return A + B; }
+};
+
+struct Minus
+{
+	static constexpr const char * name = "-";
+	static constexpr bool integral = false, joins = false;
+	static bool Defined (const Object &) { return true; }
+	static bool Fixnum (long long A, long long B, long long & R) { return !__builtin_sub_overflow (A, B, &R); }
+	static Object Exact (const bigint & A, const bigint & B) { return Object (A - B); }
+	static Object Exact (const rational & A, const rational & B) { return Object (A - B); }
+	static double Inexact (double A, double B) { return A - B; }
+};
+
+struct Times
+{
+	static constexpr const char * name = "*";
+	static constexpr bool integral = false, joins = false;
+	static bool Defined (const Object &) { return true; }
+	static bool Fixnum (long long A, long long B, long long & R) { return !__builtin_mul_overflow (A, B, &R); }
+	static Object Exact (const bigint & A, const bigint & B) { return Object (A * B); }
+	static Object Exact (const rational & A, const rational & B) { return Object (A * B); }
+	static double Inexact (double A, double B) { return A * B; }
+};
+
+struct Divide
+{
+	static constexpr const char * name = "/";
+	static constexpr bool integral = false, joins = false;
+	static bool Defined (const Object & R) { return !zerop (R); }
+	static bool Fixnum (long long A, long long B, long long & R)
+	{
+		if (B == -1 || A % B != 0)
+			return false;
+		R = A / B;
+		return true;
+	}
+	static Object Exact (const bigint & A, const bigint & B)
+	{
+		if ((A % B).sign () == 0)
+			return Object (A / B);
+		return Object (rational (A, B));
+	}
+	static Object Exact (const rational & A, const rational & B) { return Object (A / B); }
+	static double Inexact (double A, double B) { return A / B; }
+};
+
+struct Modulo
+{
+	static constexpr const char * name = "%";
+	static constexpr bool integral = true, joins = false;
+	static bool Defined (const Object & R) { return !zerop (R); }
+	static bool Fixnum (long long A, long long B, long long & R)
+	{
+		R = B == -1 ? 0 : A % B;
+		return true;
+	}
+	static Object Exact (const bigint & A, const bigint & B) { return Object (A % B); }
+};
+
+struct Equal { static constexpr const char * name = "=="; };
+struct NotEqual { static constexpr const char * name = "!="; };
+struct Less { static constexpr const char * name = "<"; };
+struct LessEqual { static constexpr const char * name = "<="; };
+struct Greater { static constexpr const char * name = ">"; };
+struct GreaterEqual { static constexpr const char * name = ">="; };
+
+struct Dispatch
+{
+	// Operand values for a known operand type
+	template <obj_type T> static double Real (const Object & O)
+	{
+		if constexpr (T == INT)
+			return double (O.intval);
+		else if constexpr (T == REAL)
+			return O.realval;
+		else if constexpr (T == BIGINT)
+			return double (BigOf (O.cell));
+		else
+			return double (RatOf (O.cell));
+	}
+
+	template <obj_type T> static bigint Integer (const Object & O)
+	{
+		if constexpr (T == INT)
+			return bigint (O.intval);
+		else
+			return BigOf (O.cell);
+	}
+
+	template <obj_type T> static decltype (auto) Rational (const Object & O)
+	{
+		if constexpr (T == RATIONAL)
+			return (RatOf (O.cell));
+		else
+			return rational (Integer <T> (O));
+	}
+
+	// Arithmetic
+	template <class Op> static Object Fail (const Object & L, const Object & R)
+	{
+		TypeError (Op::name, L, R);
+		return Object ();
+	}
+
+	template <class Op> static Object Undefined (const Object & L, const Object & R)
+	{
+		ZeroDivisor (Op::name, L, R);
+		return Object ();
+	}
+
+	template <class Op> static Object Fixnums (const Object & L, const Object & R)
+	{
+		long long result;
+		if (!Op::Defined (R))
+			return Undefined <Op> (L, R);
+		if (Op::Fixnum (L.intval, R.intval, result))
+			return Object (result);
+		return Op::Exact (bigint (L.intval), bigint (R.intval));
+	}
+
+	template <class Op, obj_type LT, obj_type RT> static Object Integers (const Object & L, const Object & R)
+	{
+		if (!Op::Defined (R))
+			return Undefined <Op> (L, R);
+		return Op::Exact (Integer <LT> (L), Integer <RT> (R));
+	}
+
+	template <class Op, obj_type LT, obj_type RT> static Object Rationals (const Object & L, const Object & R)
+	{
+		if (!Op::Defined (R))
+			return Undefined <Op> (L, R);
+		return Op::Exact (Rational <LT> (L), Rational <RT> (R));
+	}
+
+	template <class Op, obj_type LT, obj_type RT> static Object Reals (const Object & L, const Object & R)
+	{
+		if (!Op::Defined (R))
+			return Undefined <Op> (L, R);
+		return Object (Op::Inexact (Real <LT> (L), Real <RT> (R)));
+	}
+
+	static Object Concatenate (const Object & L, const Object & R)
+	{
+		return Object (StrOf (L.cell) + StrOf (R.cell));
+	}
+
+	static Object Append (const Object & L, const Object & R)
+	{
+		return append (L, R);
+	}
+
+	template <class Op> struct ArithmeticEntries
+	{
+		template <obj_type L, obj_type R> static constexpr Arithmetic Entry ()
+		{
+			if constexpr (Op::joins && L == STRING && R == STRING)
+				return Concatenate;
+			else if constexpr (Op::joins && L == LIST && R == LIST)
+				return Append;
+			else if constexpr (!IsNumber (L) || !IsNumber (R))
+				return Fail <Op>;
+			else if constexpr (L == INT && R == INT)
+				return Fixnums <Op>;
+			else if constexpr (IsInteger (L) && IsInteger (R))
+				return Integers <Op, L, R>;
+			else if constexpr (Op::integral)
+				return Fail <Op>;
+			else if constexpr (L == REAL || R == REAL)
+				return Reals <Op, L, R>;
+			else
+				return Rationals <Op, L, R>;
+		}
+	};
+
+	// Equality
+	template <class Op> static bool Unequal (const Object & L, const Object & R)
+	{
+		TypeError (Op::name, L, R);
+		return false;
+	}
+
+	static bool EqualFixnums (const Object & L, const Object & R)
+	{
+		return L.intval == R.intval;
+	}
+
+	template <obj_type LT, obj_type RT> static bool EqualIntegers (const Object & L, const Object & R)
+	{
+		return Integer <LT> (L) == Integer <RT> (R);
+	}
+
+	template <obj_type LT, obj_type RT> static bool EqualRationals (const Object & L, const Object & R)
+	{
+		return Rational <LT> (L) == Rational <RT> (R);
+	}
+
+	template <obj_type LT, obj_type RT> static bool EqualReals (const Object & L, const Object & R)
+	{
+		return Real <LT> (L) == Real <RT> (R);
+	}
+
+	static bool EqualStrings (const Object & L, const Object & R)
+	{
+		return StrOf (L.cell) == StrOf (R.cell);
+	}
+
+	static bool EqualSymbols (const Object & L, const Object & R)
+	{
+		return L.symval == R.symval;
+	}
+
+	static bool EqualVectors (const Object & L, const Object & R)
+	{
+		const vector <Object> & A = VectorOf (L.cell)->items, & B = VectorOf (R.cell)->items;
+		if (A.size () != B.size ())
+			return false;
+		for (size_t i = 0; i < A.size (); i++)
+			if (A[i] != B[i])
+				return false;
+		return true;
+	}
+
+	// Hash tables are equal only to themselves
+	static bool EqualTables (const Object & L, const Object & R)
+	{
+		return L.cell == R.cell;
+	}
+
+	// Lists of equal length that share a tail are compared up to the tail.
+	static bool EqualLists (const Object & L, const Object & R)
+	{
+		ObjectCell * A, * B;
+		for (A = L.cell, B = R.cell; A && B && A != B; A = PairOf (A)->cdr.cell, B = PairOf (B)->cdr.cell)
+			;
+		if (A != B)
+			return false;
+		for (A = L.cell, B = R.cell; A != B; A = PairOf (A)->cdr.cell, B = PairOf (B)->cdr.cell)
+			if (PairOf (A)->car != PairOf (B)->car)
+				return false;
+		return true;
+	}
+
+	template <class Op> struct EqualityEntries
+	{
+		template <obj_type L, obj_type R> static constexpr Equality Entry ()
+		{
+			if constexpr (L == INT && R == INT)
+				return EqualFixnums;
+			else if constexpr (IsNumber (L) && IsNumber (R) && (L == REAL || R == REAL))
+				return EqualReals <L, R>;
+			else if constexpr (IsInteger (L) && IsInteger (R))
+				return EqualIntegers <L, R>;
+			else if constexpr (IsNumber (L) && IsNumber (R))
+				return EqualRationals <L, R>;
+			else if constexpr (L == STRING && R == STRING)
+				return EqualStrings;
+			else if constexpr (L == SYMBOL && R == SYMBOL)
+				return EqualSymbols;
+			else if constexpr (L == HASH && R == HASH)
+				return EqualTables;
+			else if constexpr (L == VECTOR && R == VECTOR)
+				return EqualVectors;
+			else if constexpr (L == LIST && R == LIST)
+				return EqualLists;
+			else
+				return Unequal <Op>;
+		}
+	};
+
+	// Ordering: the result is negative, zero or positive
+	template <class Op> static int Unordered (const Object & L, const Object & R)
+	{
+		TypeError (Op::name, L, R);
+		return 0;
+	}
+
+	template <class T> static int Order (const T & A, const T & B)
+	{
+		return (A > B) - (A < B);
+	}
+
+	static int OrderFixnums (const Object & L, const Object & R)
+	{
+		return Order (L.intval, R.intval);
+	}
+
+	template <obj_type LT, obj_type RT> static int OrderIntegers (const Object & L, const Object & R)
+	{
+		return Order (Integer <LT> (L), Integer <RT> (R));
+	}
+
+	template <obj_type LT, obj_type RT> static int OrderRationals (const Object & L, const Object & R)
+	{
+		return Order <rational> (Rational <LT> (L), Rational <RT> (R));
+	}
+
+	template <obj_type LT, obj_type RT> static int OrderReals (const Object & L, const Object & R)
+	{
+		return Order (Real <LT> (L), Real <RT> (R));
+	}
+
+	static int OrderStrings (const Object & L, const Object & R)
+	{
+		return StrOf (L.cell).compare (StrOf (R.cell));
+	}
+
+	// Symbols are ordered by name, not by when they were interned
+	static int OrderSymbols (const Object & L, const Object & R)
+	{
+		return L.symval == R.symval ? 0 : NameOf (L.symval).compare (NameOf (R.symval));
+	}
+
+	template <class Op> struct OrderingEntries
+	{
+		template <obj_type L, obj_type R> static constexpr Ordering Entry ()
+		{
+			if constexpr (L == INT && R == INT)
+				return OrderFixnums;
+			else if constexpr (IsNumber (L) && IsNumber (R) && (L == REAL || R == REAL))
+				return OrderReals <L, R>;
+			else if constexpr (IsInteger (L) && IsInteger (R))
+				return OrderIntegers <L, R>;
+			else if constexpr (IsNumber (L) && IsNumber (R))
+				return OrderRationals <L, R>;
+			else if constexpr (L == STRING && R == STRING)
+				return OrderStrings;
+			else if constexpr (L == SYMBOL && R == SYMBOL)
+				return OrderSymbols;
+			else
+				return Unordered <Op>;
+		}
+	};
+
+	// A table holds Entries::Entry <L, R> for each pair of types
+	template <class F, class Entries, size_t... I> static constexpr Table <F> Build (index_sequence <I...>)
+	{
+		F entries [] = {Entries::template Entry <obj_type (I / TYPES), obj_type (I % TYPES)> ()...};
+		Table <F> T {};
+		for (size_t i = 0; i < sizeof... (I); i++)
+			T[i / TYPES][i % TYPES] = entries[i];
+		return T;
+	}
+
+	template <class F, class Entries> static constexpr Table <F> Build ()
+	{
+		return Build <F, Entries> (make_index_sequence <TYPES * TYPES> ());
+	}
+};
+
+static constexpr Table <Arithmetic> PlusTable = Dispatch::Build <Arithmetic, Dispatch::ArithmeticEntries <Plus>> ();
+static constexpr Table <Arithmetic> MinusTable = Dispatch::Build <Arithmetic, Dispatch::ArithmeticEntries <Minus>> ();
+static constexpr Table <Arithmetic> TimesTable = Dispatch::Build <Arithmetic, Dispatch::ArithmeticEntries <Times>> ();
+static constexpr Table <Arithmetic> DivideTable = Dispatch::Build <Arithmetic, Dispatch::ArithmeticEntries <Divide>> ();
+static constexpr Table <Arithmetic> ModuloTable = Dispatch::Build <Arithmetic, Dispatch::ArithmeticEntries <Modulo>> ();
+static constexpr Table <Equality> EqualTable = Dispatch::Build <Equality, Dispatch::EqualityEntries <Equal>> ();
+static constexpr Table <Equality> NotEqualTable = Dispatch::Build <Equality, Dispatch::EqualityEntries <NotEqual>> ();
+static constexpr Table <Ordering> LessTable = Dispatch::Build <Ordering, Dispatch::OrderingEntries <Less>> ();
+static constexpr Table <Ordering> LessEqualTable = Dispatch::Build <Ordering, Dispatch::OrderingEntries <LessEqual>> ();
+static constexpr Table <Ordering> GreaterTable = Dispatch::Build <Ordering, Dispatch::OrderingEntries <Greater>> ();
+static constexpr Table <Ordering> GreaterEqualTable = Dispatch::Build <Ordering, Dispatch::OrderingEntries <GreaterEqual>> ();
+
+/********************************************************************************/
+/* Comparison operators                                                         */
+/********************************************************************************/
+boolean Object::operator == (const Object & O) const
+{
+	Count ().operations[OP_EQUAL]++;
+	if (__builtin_expect (type == INT && O.type == INT, 1))
+		return intval == O.intval;
+	if (type == REAL && O.type == REAL)
+		return realval == O.realval;
+	return EqualTable[type][O.type] (*this, O);
+}
+
+boolean Object::operator != (const Object & O) const
+{
+	Count ().operations[OP_NOT_EQUAL]++;
+	if (__builtin_expect (type == INT && O.type == INT, 1))
+		return intval != O.intval;
+	if (type == REAL && O.type == REAL)
+		return realval != O.realval;
+	return !NotEqualTable[type][O.type] (*this, O);
+}
+
+#define ORDER(op, table, operation) \
+	Count ().operations[operation]++; \
+	if (__builtin_expect (type == INT && O.type == INT, 1)) \
+		return intval op O.intval; \
+	if (type == REAL && O.type == REAL) \
+		return realval op O.realval; \
+	return table[type][O.type] (*this, O) op 0;
+
+boolean Object::operator < (const Object & O) const
+{
+	ORDER (<, LessTable, OP_LESS)
+}
+
+boolean Object::operator <= (const Object & O) const
+{
+	ORDER (<=, LessEqualTable, OP_LESS_EQUAL)
+}
+
+boolean Object::operator > (const Object & O) const
+{
+	ORDER (>, GreaterTable, OP_GREATER)
+}
+
+boolean Object::operator >= (const Object & O) const
+{
+	ORDER (>=, GreaterEqualTable, OP_GREATER_EQUAL)
+}
+
+/********************************************************************************/
+/* Arithmetic operators                                                         */
+/********************************************************************************/
+Object Object::operator + (const Object & O) const &
+{
+	Count ().operations[OP_PLUS]++;
+	long long result;
+	if (__builtin_expect (type == INT && O.type == INT, 1))
+	{
+		if (!__builtin_add_overflow (intval, O.intval, &result))
+			return Object (result);
+	}
+	else if (type == REAL && O.type == REAL)
+		return Object (realval + O.realval);
+	return PlusTable[type][O.type] (*this, O);
+}
+
+Object Object::operator - (const Object & O) const &
+{
+	Count ().operations[OP_MINUS]++;
+	long long result;
+	if (__builtin_expect (type == INT && O.type == INT, 1))
+	{
+		if (!__builtin_sub_overflow (intval, O.intval, &result))
+			return Object (result);
+	}
+	else if (type == REAL && O.type == REAL)
+		return Object (realval - O.realval);
+	return MinusTable[type][O.type] (*this, O);
+}
+
+Object Object::operator * (const Object & O) const &
+{
+	Count ().operations[OP_TIMES]++;
+	long long result;
+	if (__builtin_expect (type == INT && O.type == INT, 1))
+	{
+		if (!__builtin_mul_overflow (intval, O.intval, &result))
+			return Object (result);
+	}
+	else if (type == REAL && O.type == REAL)
+		return Object (realval * O.realval);
+	return TimesTable[type][O.type] (*this, O);
+}
+
+Object Object::operator / (const Object & O) const &
+{
+	Count ().operations[OP_DIVIDE]++;
+	if (__builtin_expect (type == INT && O.type == INT, 1))
+	{
+		if (O.intval > 0 && intval % O.intval == 0)
+			return Object (intval / O.intval);
+	}
+	else if (type == REAL && O.type == REAL && O.realval != 0)
+		return Object (realval / O.realval);
+	return DivideTable[type][O.type] (*this, O);
+}
+
+/********************************************************************************/
+/* These operators are used when the left operand is a temporary, as in        */
+/* a + b + c. A rational or string cell that the temporary does not share is  */
+/* updated in place and a list is appended to without being copied, so the    */
+/* result needs no new cell. Everything else is left to the operators above.  */
+/********************************************************************************/
+#define IN_PLACE(op, operation) \
+	if (type == RATIONAL && cell->refs == 1 && (IsInteger (O.type) || O.type == RATIONAL)) \
+	{ \
+		Count ().operations[operation]++; \
+		static_cast <RationalCell *> (cell)->value = RatOf (cell) op RAT_OF (O); \
+		return move (*this); \
+	}
+
+Object Object::operator + (const Object & O) &&
+{
+	IN_PLACE (+, OP_PLUS)
+	if (type == STRING && O.type == STRING && cell->refs == 1)
+	{
+		Count ().operations[OP_PLUS]++;
+		static_cast <StringCell *> (cell)->value += StrOf (O.cell);
+		return move (*this);
+	}
+	if (type == LIST && O.type == LIST)
+	{
+		Count ().operations[OP_PLUS]++;
+		return append (move (*this), O);
+	}
+	return static_cast <const Object &> (*this) + O;
+}
+
+Object Object::operator - (const Object & O) &&
+{
+	IN_PLACE (-, OP_MINUS)
+	return static_cast <const Object &> (*this) - O;
+}
+
+Object Object::operator * (const Object & O) &&
+{
+	IN_PLACE (*, OP_TIMES)
+	return static_cast <const Object &> (*this) * O;
+}
+
+Object Object::operator / (const Object & O) &&
+{
+	if ((IsInteger (O.type) || O.type == RATIONAL) && !zerop (O))
+		IN_PLACE (/, OP_DIVIDE)
+	return static_cast <const Object &> (*this) / O;
+}
+
+Object Object::operator % (const Object & O) const
+{
+	Count ().operations[OP_MODULO]++;
+	if (__builtin_expect (type == INT && O.type == INT && O.intval > 0, 1))
+		return Object (intval % O.intval);
+	return ModuloTable[type][O.type] (*this, O);
+}
+
+boolean Object::operator ! () const
+{
+	Count ().operations[OP_NOT]++;
+	if (type == BOOLEAN)
+		return !boolval;
+	if (IsNumber (type))
+		return zerop (*this);
+	TypeError ("! operator", *this);
+	return false;
+}
+
+Object::operator bool () const
+{
+	if (type == BOOLEAN)
+		return boolval;
+	if (type == INT)
+		return intval != 0;
+	if (IsNumber (type))	// as operator ! does
+		return !zerop (*this);
+	TypeError ("bool operator", *this);
+	return false;
+}
+
+/********************************************************************************/
+/* Predicates                                                                   */
+/********************************************************************************/
+boolean numberp (const Object & O)
+{
+	return IsNumber (O.type);
+}
+
+boolean symbolp (const Object & O)
+{
+	return O.type == SYMBOL;
+}
+
+boolean listp (const Object & O)
+{
+	return O.type == LIST;
+}
+
+boolean zerop (const Object & O)
+{
+	if (O.type == INT)
+		return O.intval == 0;
+	if (O.type == REAL)
+		return O.realval == 0;
+	if (O.type == RATIONAL)
+		return RatOf (O.cell) == rational (0);
+	if (O.type == BIGINT)
+		return false;
+	cerr << "Wrong type for zero? predicate" << endl;
+	exit (1);
+}
+
+boolean nullp (const Object & O)
+{
+	return O.type == LIST && !O.cell;
+}
+
+boolean stringp (const Object & O)
+{
+	return O.type == STRING;
+}
+
+/********************************************************************************/
+/* List operations. Each has its own function: car, cdr, the rest of the       */
+/* c[ad]+r family (applied right to left), listof (a one element list), cons  */
+/* and append. listop still accepts an operation by name and dispatches to    */
+/* them.                                                                       */
+/********************************************************************************/
+static void ListError (const string & what, const string & S, const string & detail)
+{
+	cerr << "Wrong " << what << " for list operation function: " << S << " (" << detail << ")" << endl;
+	exit (1);
+}
+
+static bool IsCxr (const char * S, size_t length)
+{
+	if (length < 3 || S[0] != 'c' || S[length - 1] != 'r')
+		return false;
+	for (size_t i = 1; i + 1 < length; i++)
+		if (S[i] != 'a' && S[i] != 'd')
+			return false;
+	return true;
+}
+
+Object car (const Object & O)
+{
+	Count ().listOperations[LIST_CAR]++;
+	if (O.type != LIST)
+		ListError ("type", "car", O.getType ());
+	if (!O.cell)
+		ListError ("size", "car", "0");
+	return PairOf (O.cell)->car;
+}
+
+Object cdr (const Object & O)
+{
+	Count ().listOperations[LIST_CDR]++;
+	if (O.type != LIST)
+		ListError ("type", "cdr", O.getType ());
+	if (!O.cell)
+		ListError ("size", "cdr", "0");
+	return PairOf (O.cell)->cdr;
+}
+
+Object cxr (const char * S, const Object & O)
+{
+	Count ().listOperations[LIST_CXR]++;
+	size_t length = strlen (S);
+	if (O.type != LIST)
+		ListError ("type", S, O.getType ());
+	if (!O.cell)
+		ListError ("size", S, "0");
+	if (!IsCxr (S, length))
+		ListError ("name", S, "list operator may need 2 parameters");
+	const Object * R = &O;
+	for (size_t i = length - 2; i > 0; i--)
+	{
+		if (R->type != LIST)
+			ListError ("type", S, R->getType ());
+		if (!R->cell)
+			ListError ("size", S, "0");
+		R = S[i] == 'a' ? &PairOf (R->cell)->car : &PairOf (R->cell)->cdr;
+	}
+	return *R;
+}
+
+Object listof (const Object & O)
+{
+	Count ().listOperations[LIST_LIST]++;
+	return Object (LIST, new PairCell (O, Object (LIST, NULL)));
+}
+
+Object cons (const Object & O1, const Object & O2)
+{
+	Count ().listOperations[LIST_CONS]++;
+	if (O2.type != LIST)
+		ListError ("type", "cons", O1.getType () + " or " + O2.getType ());
+	return Object (LIST, new PairCell (O1, O2));
+}
+
+Object append (const Object & O1, const Object & O2)
+{
+	Count ().listOperations[LIST_APPEND]++;
+	if (O1.type != LIST || O2.type != LIST)
+		ListError ("type", "append", O1.getType () + " or " + O2.getType ());
+	Object R (LIST, NULL);
+	Object * tail = &R;
+	for (ObjectCell * P = O1.cell; P; P = PairOf (P)->cdr.cell)
+	{
+		tail->cell = new PairCell (PairOf (P)->car, Object (LIST, NULL));
+		tail = &PairOf (tail->cell)->cdr;
+		Count ().elementCopies++;
+	}
+	*tail = O2;
+	return R;
+}
+
+/********************************************************************************/
+/* When the first list is a temporary, the leading pairs that no other Object  */
+/* shares are reused as they are; only the shared remainder, if any, is copied */
+/* before the second list is linked on.                                         */
+/********************************************************************************/
+Object append (Object && O1, const Object & O2)
+{
+	if (O1.type != LIST || O2.type != LIST)
+		ListError ("type", "append", O1.getType () + " or " + O2.getType ());
+	Object * tail = &O1;
+	while (tail->cell && tail->cell->refs == 1)
+		tail = &PairOf (tail->cell)->cdr;
+	if (!tail->cell)	// otherwise counted by the append of the shared remainder
+		Count ().listOperations[LIST_APPEND]++;
+	*tail = tail->cell ? append (*tail, O2) : O2;
+	return move (O1);
+}
+
+Object listop (const string & S, const Object & O)
+{
+	if (S == "list")
+		return listof (O);
+	return cxr (S.c_str (), O);
+}
+
+Object listop (const string & S, const Object & O1, const Object & O2)
+{
+	if (S == "cons")
+		return cons (O1, O2);
+	if (S == "append")
+		return append (O1, O2);
+	ListError ("name", S, "list operator may accept only 1 parameter");
+	return Object ();
+}
+
+Object round (const Object & O)
+{
+	Count ().operations[OP_ROUND]++;
+	if (IsInteger (O.type))
+		return O;
+	if (O.type == REAL)
+		return Object (bigint (floor (O.realval + 0.5)));
+	if (O.type == RATIONAL)
+	{
+		rational R = RatOf (O.cell);
+		return Object (R.round ().numerator ());
+	}
+	TypeError ("round function parameter", O);
+	return Object ();
+}
+
+/********************************************************************************/
+/* Hash tables. Keys are hashed consistently with ==: numbers hash by their     */
+/* value as a double, so 1, 1.0 and 2/2 share a hash, and a symbol hashes by    */
+/* its index. Keys of types that == cannot compare are simply different keys.  */
+/* Lists and vectors hash by their contents, so a vector should not be changed */
+/* while it is a key.                                                           */
+/* A table is kept at most half full so that probe sequences stay short.       */
+/********************************************************************************/
+struct HashTable
+{
+	static size_t Mix (unsigned long long X)
+	{
+		X ^= X >> 30;
+		X *= 0xbf58476d1ce4e5b9ULL;
+		X ^= X >> 27;
+		X *= 0x94d049bb133111ebULL;
+		return size_t (X ^ (X >> 31));
+	}
+
+	static size_t Number (double D)
+	{
+		unsigned long long bits;
+		if (D == 0)
+			D = 0;
+		memcpy (&bits, &D, sizeof bits);
+		return Mix (bits);
+	}
+
+	static size_t Hash (const Object & O)
+	{
+		switch (O.type)
+		{
+			case INT:
+				return Number (double (O.intval));
+			case REAL:
+				return Number (O.realval);
+			case RATIONAL:
+				return Number (double (RatOf (O.cell)));
+			case BIGINT:
+				return Number (double (BigOf (O.cell)));
+			case STRING:
+				return std::hash <string> () (StrOf (O.cell));
+			case SYMBOL:
+				return Mix (O.symval + 1);
+			case BOOLEAN:
+				return Mix (O.boolval ? 3 : 2);
+			case HASH:
+				return Mix (uintptr_t (O.cell));
+			case VECTOR:
+			{
+				size_t H = 5;
+				for (const Object & X : VectorOf (O.cell)->items)
+					H = H * 31 + Hash (X);
+				return Mix (H);
+			}
+			case LIST:
+			{
+				size_t H = 4;
+				for (ObjectCell * P = O.cell; P; P = PairOf (P)->cdr.cell)
+					H = H * 31 + Hash (PairOf (P)->car);
+				return Mix (H);
+			}
+			default:
+				return 0;
+		}
+	}
+
+	static bool Same (const Object & A, const Object & B)
+	{
+		if (IsNumber (A.type) && IsNumber (B.type))
+			return A == B;
+		if (A.type != B.type)
+			return false;
+		switch (A.type)
+		{
+			case STRING:
+				return StrOf (A.cell) == StrOf (B.cell);
+			case SYMBOL:
+				return A.symval == B.symval;
+			case BOOLEAN:
+				return A.boolval == B.boolval;
+			case LIST:
+			{
+				ObjectCell * P, * Q;
+				for (P = A.cell, Q = B.cell; P && Q && P != Q; P = PairOf (P)->cdr.cell, Q = PairOf (Q)->cdr.cell)
+					if (!Same (PairOf (P)->car, PairOf (Q)->car))
+						return false;
+				return P == Q;
+			}
+			case VECTOR:
+			{
+				const vector <Object> & X = VectorOf (A.cell)->items, & Y = VectorOf (B.cell)->items;
+				if (X.size () != Y.size ())
+					return false;
+				for (size_t i = 0; i < X.size (); i++)
+					if (!Same (X[i], Y[i]))
+						return false;
+				return true;
+			}
+			default:
+				return A.cell == B.cell;
+		}
+	}
+
+	// The slot holding K, or the empty slot where K would go
+	static HashSlot & Find (HashCell * T, const Object & K, size_t H)
+	{
+		size_t mask = T->slots.size () - 1;
+		for (size_t i = H & mask; ; i = (i + 1) & mask)
+		{
+			HashSlot & S = T->slots[i];
+			if (S.key.type == NONE || (S.hash == H && Same (S.key, K)))
+				return S;
+		}
+	}
+
+	static void Grow (HashCell * T)
+	{
+		vector <HashSlot> old (T->slots.size () * 2);
+		old.swap (T->slots);
+		for (HashSlot & S : old)
+			if (S.key.type != NONE)
+				Find (T, S.key, S.hash) = move (S);
+	}
+
+	static HashCell * Table (const Object & T, const char * function)
+	{
+		if (T.type != HASH)
+			TypeError (function, T);
+		return TableOf (T.cell);
+	}
+};
+
+Object make_hash_table ()
+{
+	return Object (HASH, new HashCell);
+}
+
+Object hash_ref (const Object & T, const Object & K)
+{
+	HashCell * table = HashTable::Table (T, "hash-ref table");
+	HashSlot & S = HashTable::Find (table, K, HashTable::Hash (K));
+	if (S.key.type == NONE)
+	{
+		cerr << "No value found for hash-ref key: " << K << endl;
+		exit (1);
+	}
+	return S.value;
+}
+
+Object hash_set (const Object & T, const Object & K, const Object & V)
+{
+	HashCell * table = HashTable::Table (T, "hash-set! table");
+	if (K.type == NONE)
+		TypeError ("hash-set! key", K);
+	size_t H = HashTable::Hash (K);
+	HashSlot * S = &HashTable::Find (table, K, H);
+	if (S->key.type == NONE)
+	{
+		if (2 * (table->count + 1) > table->slots.size ())
+		{
+			HashTable::Grow (table);
+			S = &HashTable::Find (table, K, H);
+		}
+		S->hash = H;
+		S->key = K;
+		table->count++;
+	}
+	S->value = V;
+	return T;
+}
+
+Object hash_count (const Object & T)
+{
+	return Object ((long long) HashTable::Table (T, "hash-count table")->count);
+}
+
+/********************************************************************************/
+/* Vectors. A length or index must be a fixnum; an index must be less than the  */
+/* vector's length.                                                             */
+/********************************************************************************/
+struct Vectors
+{
+	static VectorCell * Vector (const Object & V, const char * function)
+	{
+		if (V.type != VECTOR)
+			TypeError (function, V);
+		return VectorOf (V.cell);
+	}
+
+	static size_t Index (const VectorCell * V, const Object & K, const char * function)
+	{
+		if (K.type != INT || K.intval < 0 || (unsigned long long) K.intval >= V->items.size ())
+		{
+			cerr << "Wrong index for " << function << ": " << K << " (length " << V->items.size () << ")" << endl;
+			exit (1);
+		}
+		return size_t (K.intval);
+	}
+};
+
+Object make_vector (const Object & K, const Object & X)
+{
+	if (K.type != INT || K.intval < 0)
+		TypeError ("make-vector length", K);
+	return Object (VECTOR, new VectorCell (size_t (K.intval), X));
+}
+
+Object vector_ref (const Object & V, const Object & K)
+{
+	VectorCell * vector = Vectors::Vector (V, "vector-ref vector");
+	return vector->items[Vectors::Index (vector, K, "vector-ref")];
+}
+
+Object vector_set (const Object & V, const Object & K, const Object & X)
+{
+	VectorCell * vector = Vectors::Vector (V, "vector-set! vector");
+	vector->items[Vectors::Index (vector, K, "vector-set!")] = X;
+	return V;
+}
+
+Object vector_length (const Object & V)
+{
+	return Object ((long long) Vectors::Vector (V, "vector-length vector")->items.size ());
+}
+
+/********************************************************************************/
+/* Input and output                                                             */
+/********************************************************************************/
+/********************************************************************************/
+/* Objects are formatted into a character buffer: numbers with to_chars, and   */
+/* lists, vectors and hash tables iteratively, keeping a stack of the          */
+/* containers being written instead of recursing into their elements.          */
+/********************************************************************************/
+struct Printer
+{
+	struct Frame
+	{
+		obj_type type;
+		ObjectCell * cell;	// LIST: the next pair; VECTOR and HASH: the container
+		size_t index;		// the number of elements written, or the next slot
+		int part;			// HASH: 0 before a slot's key, 1 before its value
+	};
+	static void Format (string & out, const Object & O);
+	static bool Atom (string & out, const Object & O);
+	static Frame Open (string & out, const Object & O);
+	static const Object * Next (string & out, Frame & F);
+	static void Number (string & out, long long I);
+	static void Number (string & out, double D);
+	static void Number (string & out, const bigint & B);
+};
+
+void Printer::Number (string & out, long long I)
+{
+	char text [24];
+	out.append (text, to_chars (text, text + sizeof text, I).ptr);
+}
+
+void Printer::Number (string & out, double D)
+{
+	// The same digits as an ostream's default (%g with 6 significant digits)
+	char text [32];
+	out.append (text, to_chars (text, text + sizeof text, D, chars_format::general, 6).ptr);
+}
+
+void Printer::Number (string & out, const bigint & B)
+{
+	if (B.fits ())
+		Number (out, B.value ());
+	else
+		out += to_string (B);
+}
+
+/********************************************************************************/
+/* This function writes O if it is not a non-empty container, returning false  */
+/* for a list, vector or hash table whose elements remain to be written.       */
+/********************************************************************************/
+bool Printer::Atom (string & out, const Object & O)
+{
+	switch (O.type)
+	{
+		case INT:
+			Number (out, O.intval);
+			return true;
+		case REAL:
+			Number (out, O.realval);
+			return true;
+		case STRING:
+			out += StrOf (O.cell);
+			return true;
+		case SYMBOL:
+			out += NameOf (O.symval);
+			return true;
+		case RATIONAL:
+		{
+			rational R = RatOf (O.cell);
+			R.reduce ();
+			Number (out, R.num);
+			if (R.denom != 1LL)
+			{
+				out += '/';
+				Number (out, R.denom);
+			}
+			return true;
+		}
+		case BIGINT:
+			Number (out, BigOf (O.cell));
+			return true;
+		case BOOLEAN:
+			out += O.boolval ? "#t" : "#f";
+			return true;
+		case LIST:
+			if (O.cell)
+				return false;
+			out += "()";
+			return true;
+		case HASH:
+		case VECTOR:
+			return false;
+		default:
+			return true;
+	}
+}
+
+Printer::Frame Printer::Open (string & out, const Object & O)
+{
+	out += O.type == LIST ? "(" : O.type == VECTOR ? "#(" : "#hash(";
+	return Frame {O.type, O.cell, 0, 0};
+}
+
+/********************************************************************************/
+/* This function writes the separator before the next element of the container */
+/* F and returns that element, or closes the container and returns NULL.       */
+/********************************************************************************/
+const Object * Printer::Next (string & out, Frame & F)
+{
+	if (F.type == LIST)
+	{
+		if (F.cell == NULL)
+		{
+			out += ')';
+			return NULL;
+		}
+		if (F.index++)
+			out += ' ';
+		const Object * car = &PairOf (F.cell)->car;
+		F.cell = PairOf (F.cell)->cdr.cell;
+		return car;
+	}
+	if (F.type == VECTOR)
+	{
+		const vector <Object> & items = VectorOf (F.cell)->items;
+		if (F.index == items.size ())
+		{
+			out += ')';
+			return NULL;
+		}
+		if (F.index)
+			out += ' ';
+		return &items[F.index++];
+	}
+	const vector <HashSlot> & slots = TableOf (F.cell)->slots;
+	if (F.part == 1)
+	{
+		out += " . ";
+		F.part = 0;
+		return &slots[F.index++].value;
+	}
+	if (F.index > 0)
+		out += ')';
+	while (F.index < slots.size () && slots[F.index].key.type == NONE)
+		F.index++;
+	if (F.index == slots.size ())
+	{
+		out += ')';
+		return NULL;
+	}
+	out += out.back () == '(' ? "(" : " (";
+	F.part = 1;
+	return &slots[F.index].key;
+}
+
+/********************************************************************************/
+/* The stack of open containers, and operator <<'s text, are kept between       */
+/* calls so that formatting does not allocate; each thread has its own. A       */
+/* call made while another is writing takes a text of its own.                  */
+/********************************************************************************/
+void Printer::Format (string & out, const Object & O)
+{
+	static thread_local vector <Frame> stack;
+	if (Atom (out, O))
+		return;
+	size_t base = stack.size ();
+	stack.push_back (Open (out, O));
+	while (stack.size () > base)
+	{
+		const Object * X = Next (out, stack.back ());
+		if (X == NULL)
+			stack.pop_back ();
+		else if (!Atom (out, *X))
+			stack.push_back (Open (out, *X));
+	}
+}
+
+ostream & operator << (ostream & outs, const Object & O)
+{
+	static thread_local string spare;
+	string text;
+	text.swap (spare);
+	text.clear ();
+	Printer::Format (text, O);
+	outs.write (text.data (), text.size ());
+	spare.swap (text);
+	return outs;
+}
+
+/********************************************************************************/
+/* display and newline write to a buffer owned by the runtime instead of cout.  */
+/* The buffer is written to standard output when it fills, before standard     */
+/* input is read, before anything is written to cout or cerr and when the       */
+/* program exits, including through exit ().                                    */
+/********************************************************************************/
+struct OutputBuffer : streambuf
+{
+	static const size_t LIMIT = 1 << 16;
+	string text;
+	ostream tied;
+	OutputBuffer () : tied (this)
+	{
+		text.reserve (LIMIT);
+		cout.tie (&tied);
+		cerr.tie (&tied);
+	}
+	~OutputBuffer ()
+	{
+		Flush ();
+		cout.tie (NULL);
+		cerr.tie (&cout);
+	}
+	int sync () override
+	{
+		Flush ();
+		return 0;
+	}
+	void Flush ();
+};
+
+void OutputBuffer::Flush ()
+{
+	cout.rdbuf ()->pubsync ();
+	const char * next = text.data ();
+	const char * last = next + text.size ();
+	while (next < last)
+	{
+		ssize_t n = ::write (1, next, last - next);
+		if (n < 0 && errno != EINTR)
+			break;
+		next += max (n, ssize_t (0));
+	}
+	text.clear ();
+}
+
+static OutputBuffer & Output ()
+{
+	static OutputBuffer buffer;
+	return buffer;
+}
+
+static void FlushOutput ()
+{
+	Output ().Flush ();
+}
+
+void display (const Object & O)
+{
+	OutputBuffer & output = Output ();
+	Printer::Format (output.text, O);
+	if (output.text.size () >= OutputBuffer::LIMIT)
+		output.Flush ();
+}
+
+void display (const char * S)
+{
+	OutputBuffer & output = Output ();
+	output.text += S;
+	if (output.text.size () >= OutputBuffer::LIMIT)
+		output.Flush ();
+}
+
+void newline ()
+{
+	OutputBuffer & output = Output ();
+	output.text += '\n';
+	if (output.text.size () >= OutputBuffer::LIMIT)
+		output.Flush ();
+}
+
+/********************************************************************************/
+/* This function reads the next datum from ins into O. At the end of the input */
+/* O is the string #<eof> and ins has its eofbit set.                           */
+/********************************************************************************/
+istream & operator >> (istream & ins, Object & O)
+{
+	if (!ins.good ())
+		O = Object (string ("#<eof>"));
+	else if (&ins == &cin && ins.rdbuf () == StdinBuffer)
+	{
+		if (Reader::SkipSpace (Stdin) == EOF)
+			ins.setstate (ios::eofbit);
+		O = Reader::Datum (Stdin, false);
+	}
+	else
+	{
+		StreamSource in {ins.rdbuf ()};
+		if (Reader::SkipSpace (in) == EOF)
+			ins.setstate (ios::eofbit);
+		O = Reader::Datum (in, false);
+	}
+	return ins;
+}
+
+Object read (istream & ins)
+{
+	Object O;
+	ins >> O;
+	return O;
+}
+
+string Object::getType () const
+{
+	return typeNames[type == BIGINT ? INT : type];
+}
+
+/********************************************************************************/
+/* Cycle collector. Reference counts free almost every cell; what they miss are */
+/* cells that only reference each other. A collection examines the nursery, or  */
+/* the whole heap when it has grown past PL460_HEAP, and subtracts from each    */
+/* cell's count the references held by other examined cells. Cells left with a  */
+/* positive count are referenced from outside (C++ variables, temporaries or    */
+/* old cells), so they are the roots; everything reachable from them is live    */
+/* and the rest is garbage. Survivors are promoted out of the nursery.          */
+/********************************************************************************/
+void Object::Collect (bool major)
+{
+	chrono::steady_clock::time_point start = chrono::steady_clock::now ();
+	heap.collecting = true;
+	vector <ObjectCell *> cells, work, garbage;
+	auto examined = [major] (const Object & O)
+	{
+		return OnHeap (O.type) && O.cell && (major || !O.cell->old) && !ChunkOf (O.cell)->arena;
+	};
+	for (int sc = 0; sc < SIZE_CLASSES; sc++)
+		for (Chunk * K = heap.chunks[sc]; K; K = K->next)
+		{
+			if (!major && K->young == 0)
+				continue;
+			K->gcrefs = new int [K->count];
+			for (size_t i = 0; i < K->used; i++)
+			{
+				ObjectCell * C = (ObjectCell *) (K->first + i * K->slot);
+				if (C->kind != NONE && (major || !C->old))
+				{
+					cells.push_back (C);
+					K->gcrefs[i] = C->refs;
+				}
+			}
+		}
+	for (ObjectCell * C : cells)
+		ForChildren (C, [&] (Object & child)
+		{
+			if (examined (child))
+				GCRefs (child.cell)--;
+		});
+	for (ObjectCell * C : cells)
+		if (GCRefs (C) > 0)
+			work.push_back (C);
+	while (!work.empty ())
+	{
+		ObjectCell * C = work.back ();
+		work.pop_back ();
+		ForChildren (C, [&] (Object & child)
+		{
+			if (examined (child) && GCRefs (child.cell) == 0)
+			{
+				GCRefs (child.cell) = 1;
+				work.push_back (child.cell);
+			}
+		});
+	}
+	for (ObjectCell * C : cells)
+		if (GCRefs (C) == 0)
+		{
+			GCRefs (C) = -1;
+			garbage.push_back (C);
+		}
+		else if (!C->old)
+		{
+			C->old = true;
+			ChunkOf (C)->young--;
+		}
+	for (ObjectCell * C : garbage)
+		ForChildren (C, [&] (Object & child)
+		{
+			if (examined (child) && GCRefs (child.cell) == -1)
+				child.type = NONE;
+		});
+	for (ObjectCell * C : garbage)
+	{
+		if (C->kind == STRING)
+			delete static_cast <StringCell *> (C);
+		else if (C->kind == RATIONAL)
+			delete static_cast <RationalCell *> (C);
+		else if (C->kind == BIGINT)
+			delete static_cast <BigCell *> (C);
+		else if (C->kind == HASH)
+			delete TableOf (C);
+		else if (C->kind == VECTOR)
+			delete VectorOf (C);
+		else
+			delete PairOf (C);
+	}
+	for (int sc = 0; sc < SIZE_CLASSES; sc++)
+		for (Chunk * K = heap.chunks[sc]; K; K = K->next)
+		{
+			delete [] K->gcrefs;
+			K->gcrefs = NULL;
+		}
+	if (major && heap.heapBytes >= heap.heapLimit)
+		heap.heapLimit *= 2;
+	heap.sinceCollection = 0;
+	heap.reclaimed += garbage.size ();
+	(major ? heap.major : heap.minor)++;
+	double pause = chrono::duration <double, milli> (chrono::steady_clock::now () - start).count ();
+	heap.pauseTotal += pause;
+	heap.pauseMax = max (heap.pauseMax, pause);
+	heap.collecting = false;
+}
+
+void gc_collect ()
+{
+	if (!heap.collecting)
+		Object::Collect (true);
+}
+
+unsigned long long gc_allocated ()
+{
+	return heap.cells;
+}
+
+void gc_stats (ostream & outs)
+{
+	unsigned long count = heap.minor + heap.major;
+	outs << "GC: " << heap.minor << " minor and " << heap.major << " full collections; pause total "
+	     << heap.pauseTotal << " ms, max " << heap.pauseMax << " ms, mean "
+	     << (count ? heap.pauseTotal / count : 0) << " ms" << endl;
+	outs << "GC: " << heap.reclaimed << " cells reclaimed; heap " << heap.heapBytes / 1024 << " KB (peak "
+	     << heap.peakBytes / 1024 << " KB, limit " << heap.heapLimit / 1024 << " KB); "
+	     << heap.cells << " cells (" << heap.allocated / 1024 << " KB) allocated" << endl;
+	outs << "GC: " << heap.regionsReset << " regions reset, " << heap.regionsPromoted << " promoted" << endl;
+}
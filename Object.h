@@ -5,10 +5,10 @@
 *    																		   *
 * Author: Seth Nuzum                                                           *
 * Date: 11-17-23                                                               *
-* File: LexicalAnalyzer.h                                                      *
+* File: Object.h                                                               *
 *                                                                              *
-* Description: This file contains the description of the Object class and two  *
-*              related classes: rational and boolean.                          *
+* Description: This file contains the description of the Object class and    *
+*              three related classes: bigint, rational and boolean.            *
 *******************************************************************************/
 
 #include <iostream>
@@ -16,8 +16,66 @@
 #include <vector>
 using namespace std;
 
-enum obj_type {NONE, INT, REAL, STRING, RATIONAL, BOOLEAN, LIST};
+enum obj_type {NONE, INT, REAL, STRING, RATIONAL, BOOLEAN, LIST, BIGINT, SYMBOL, HASH, VECTOR};
+
+struct ObjectCell;
+struct Chunk;
+	
+/*****************************************************************
+* Description: The following is the definition of a class        *
+*              called bigint. Objects of the bigint class        *
+*              will contain a signed integer of any size. A      *
+*              value that fits in a long long is held directly   *
+*              and operated on with overflow checks; larger      *
+*              values are held as base 2^32 digits.              *
+*****************************************************************/
+
+class bigint
+{
+    public:
+	bigint ();
+	bigint (const long long I);
+	bigint (const double D);
+	bigint (const string & S);
+	
+	// Input and Output Operators
+	friend ostream & operator <<
+				(ostream & output, const bigint & B);
+	friend string to_string (const bigint & B);
+	
+	// Logical Operators
+	bool operator != (const bigint & B) const;
+	bool operator > (const bigint & B) const;
+	bool operator >= (const bigint & B) const;
+	bool operator == (const bigint & B) const;
+	bool operator < (const bigint & B) const;
+	bool operator <= (const bigint & B) const;
+	
+	// Arithmetic Operators (/ and % truncate toward zero)
+	bigint operator + (const bigint & B) const;
+	bigint operator - (const bigint & B) const;
+	bigint operator * (const bigint & B) const;
+	bigint operator / (const bigint & B) const;
+	bigint operator % (const bigint & B) const;
+	bigint operator - () const;
 	
+	// Conversion Operators
+	explicit operator double () const;
+	bool fits () const;			// true if the value fits in a long long
+	long long value () const;	// the value, when fits () is true
+	int sign () const;
+	friend bigint gcd (const bigint & A, const bigint & B);
+
+    private:
+	bigint (bool negative, vector <unsigned> & magnitude);
+	vector <unsigned> magnitude () const;
+	bool negative () const;
+	static bigint DivMod (const bigint & A, const bigint & B, bool remainder);
+	long long fixnum;			// the value, when digits is empty
+	bool minus;					// the sign, when digits is not empty
+	vector <unsigned> digits;	// magnitude, least significant first
+};
+
 /*****************************************************************
 * Description: The following is the definition of a class        *
 *              called rational. Objects of the rational class    *
@@ -50,6 +108,8 @@ class rational
 	rational (const int numerator, const int denominator);
 	rational (const int I);
 	rational (const double D);
+	rational (const bigint & I);
+	rational (const bigint & numerator, const bigint & denominator);
 	
 	// Logical Operators
 	bool operator != (const rational & R) const;
@@ -86,10 +146,15 @@ class rational
 	// Other Methods
 	rational reduce ();			
 	rational reciprocal () const;	
+	bigint numerator () const;
+	bigint denominator () const;
 
     private:
-	int num;
-	int denom;
+	friend struct Printer;
+	void settle ();
+	void lowest ();
+	bigint num;
+	bigint denom;
 };
 
 /*****************************************************************
@@ -116,26 +181,48 @@ class boolean
 *              called Object. Objects of the Object class        *
 *              will contain a a variety of scalar types and      *
 *              lists.                                            *
+*              An Object is a 16 byte tagged value: integers     *
+*              that fit in 64 bits, reals, booleans and symbols  *
+*              are stored in place, while larger integers,       *
+*              strings, rationals and list pairs are stored in   *
+*              shared, reference counted cells. A symbol holds   *
+*              the index of its name in the symbol table, so     *
+*              symbols with the same name are the same value.    *
+*              Hash tables and vectors are shared, mutable       *
+*              cells: every copy of the Object refers to the     *
+*              same table or vector. A vector's elements are     *
+*              stored contiguously.                              *
 *****************************************************************/
 class Object
 {
     public:
 	Object();
 	Object (const int & value);
+	Object (const long long & value);
+	Object (const bigint & value);
 	Object (const double & value);
 	Object (const string & value);
 	Object (const rational & value);
 	Object (const boolean & value);
+	Object (const Object & O);
+	Object (Object && O) noexcept;
+	~Object ();
+	Object & operator = (const Object & O);
+	Object & operator = (Object && O) noexcept;
 	boolean operator == (const Object & O) const;
 	boolean operator != (const Object & O) const;
 	boolean operator < (const Object & O) const;
 	boolean operator <= (const Object & O) const;
 	boolean operator > (const Object & O) const;
 	boolean operator >= (const Object & O) const;
-	Object operator + (const Object & O) const;
-	Object operator - (const Object & O) const;
-	Object operator * (const Object & O) const;
-	Object operator / (const Object & O) const;
+	Object operator + (const Object & O) const &;
+	Object operator - (const Object & O) const &;
+	Object operator * (const Object & O) const &;
+	Object operator / (const Object & O) const &;
+	Object operator + (const Object & O) &&;
+	Object operator - (const Object & O) &&;
+	Object operator * (const Object & O) &&;
+	Object operator / (const Object & O) &&;
 	Object operator % (const Object & O) const;
 	boolean operator ! () const;
 	operator bool () const;
@@ -145,25 +232,91 @@ class Object
 	friend boolean zerop (const Object & O);
 	friend boolean nullp (const Object & O);
 	friend boolean stringp (const Object & O);
+	friend Object car (const Object & O);
+	friend Object cdr (const Object & O);
+	friend Object cxr (const char * S, const Object & O);
+	friend Object listof (const Object & O);
+	friend Object cons (const Object & O1, const Object & O2);
+	friend Object append (const Object & O1, const Object & O2);
+	friend Object append (Object && O1, const Object & O2);
 	friend Object listop (const string & S, const Object & O);
-	friend Object listop (const string & S, const Object & O1, const Object O2);
+	friend Object listop (const string & S, const Object & O1, const Object & O2);
 	friend Object round (const Object & O);
+	friend Object symbol (const string & name);
+	friend Object make_hash_table ();
+	friend Object hash_ref (const Object & T, const Object & K);
+	friend Object hash_set (const Object & T, const Object & K, const Object & V);
+	friend Object hash_count (const Object & T);
+	friend Object make_vector (const Object & K, const Object & X);
+	friend Object vector_ref (const Object & V, const Object & K);
+	friend Object vector_set (const Object & V, const Object & K, const Object & X);
+	friend Object vector_length (const Object & V);
 	friend ostream & operator << (ostream & outs, const Object & O);
 	friend istream & operator >> (istream & ins, Object & O);
+	friend void gc_collect ();
 	string getType () const;
     private:
-	Object (stringstream & ss);
-	void MakeName ();
+	friend struct ObjectCell;
+	friend struct Dispatch;
+	friend struct Reader;
+	friend struct HashTable;
+	friend struct Vectors;
+	friend struct Printer;
+	static void Collect (bool major);
+	static Object Element (const string & text);
+	Object (obj_type T, ObjectCell * C);
+	void Release ();
 	obj_type type;
-	string name;
-	int intval;
-	double realval;
-	string strval;
-	rational ratval;
-	boolean boolval;
-	vector <Object> listval;
+	union
+	{
+		long long intval;
+		double realval;
+		bool boolval;
+		long long symval;	// SYMBOL: index in the symbol table
+		ObjectCell * cell;	// STRING, RATIONAL, BIGINT, HASH, VECTOR and LIST (NULL if empty)
+	};
 };
 
 Object read (istream & ins);
+Object symbol (const string & name);
+Object make_hash_table ();
+Object make_vector (const Object & K, const Object & X = Object (0));
+
+// Output of the generated programs, buffered by the runtime; see Object.cpp.
+void display (const Object & O);
+void display (const char * S);
+void newline ();
+
+/*****************************************************************
+* Description: A Region holds the cells allocated by one        *
+*              activation of a generated function. It is opened *
+*              at the start of the function and closed when the  *
+*              function returns; if none of its cells outlived   *
+*              the activation, they are all freed at once.       *
+*              Nested regions share one arena, each from the     *
+*              mark where it opened.                             *
+*****************************************************************/
+class Region
+{
+    public:
+	Region ();
+	~Region ();
+	Region (const Region &) = delete;
+	Region & operator = (const Region &) = delete;
+    private:
+	friend struct ObjectCell;
+	static void * Allocate (int sc);
+	static bool Dead (Chunk * K, size_t from);
+	static void Promote (Chunk * K, int sc);
+	Region * outer;			// the region open when this one was opened
+	Chunk * mark [8];		// the arena chunk being carved, by cell size class
+	size_t used [8];		// and how many of its cells were carved
+};
+
+// Cycle collection for the cell heap; see Object.cpp for the PL460_NURSERY,
+// PL460_HEAP and PL460_GC_STATS settings.
+void gc_collect ();
+void gc_stats (ostream & outs);
+unsigned long long gc_allocated ();	// the number of cells allocated so far
 
 #endif
@@ -5,16 +5,28 @@
 #include "Object.h"
 using namespace std;
 
+extern const Object symbols [];
+extern Object constants [];
+
 int main() {
-	cout << 5;
-	cout << endl;
-	cout << -101;
-	cout << endl;
-	cout << 0;
-	cout << endl;
-	cout << 3.14159;
-	cout << endl;
-	cout << -3.5;
-	cout << endl;
+	display (constants[0]);
+	newline ();
+	display (constants[1]);
+	newline ();
+	display (constants[2]);
+	newline ();
+	display (constants[3]);
+	newline ();
+	display (constants[4]);
+	newline ();
 }
 
+
+const Object symbols [] = {symbol ("main")};
+
+Object constants [] = {
+	Object ("5"),
+	Object ("-101"),
+	Object ("0"),
+	Object ("3.14159"),
+	Object ("-3.5")};
@@ -0,0 +1,376 @@
+/*******************************************************************************
+* Title: Phase timing for Scheme to C++ Translator                             *
+* Author: Seth Nuzum                                                           *
+* Date: 11-17-23                                                               *
+* File: Phases.cpp                                                             *
+*                                                                              *
+* Description: This file contains the implementation of the Phase timer and   *
+*              of OutputFile.                                                  *
+*******************************************************************************/
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include "Phases.h"
+
+using namespace std;
+
+thread_local bool phaseTiming = false;
+thread_local long long Phase::tokens = 0;
+thread_local long long Phase::rules = 0;
+
+static const char * phase_names [] = {"lex", "parse", "generate", "write"};
+
+struct FileRecord
+{
+	string name;
+	long long bytes;
+	double seconds;
+};
+
+// The state of the current thread's timer
+static thread_local phase_type current = PARSE_P;
+static thread_local double wall [PHASES], cpu [PHASES];
+static thread_local double startWall, startCpu, lastWall, lastCpu;
+static thread_local vector <FileRecord> files;
+
+static double Now (clockid_t clock)
+{
+	timespec t;
+	clock_gettime (clock, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/********************************************************************************/
+/* This function starts timing on the current thread, from zero. Until it is   */
+/* called, Phase objects measure nothing.                                       */
+/********************************************************************************/
+void Phase::Start ()
+{
+	phaseTiming = true;
+	current = PARSE_P;
+	for (int p = 0; p < PHASES; p++)
+		wall[p] = cpu[p] = 0;
+	tokens = rules = 0;
+	files.clear ();
+	startWall = lastWall = Now (CLOCK_MONOTONIC);
+	startCpu = lastCpu = Now (CLOCK_THREAD_CPUTIME_ID);
+}
+
+/********************************************************************************/
+/* This function charges the time since the last switch to the current phase,   */
+/* makes p the current phase and returns the one it replaced.                   */
+/********************************************************************************/
+phase_type Phase::Switch (phase_type p)
+{
+	double nowWall = Now (CLOCK_MONOTONIC), nowCpu = Now (CLOCK_THREAD_CPUTIME_ID);
+	wall[current] += nowWall - lastWall;
+	cpu[current] += nowCpu - lastCpu;
+	lastWall = nowWall;
+	lastCpu = nowCpu;
+	phase_type replaced = current;
+	current = p;
+	return replaced;
+}
+
+/********************************************************************************/
+/* This function returns the wall time charged to phase p since Start.         */
+/********************************************************************************/
+double Phase::Seconds (phase_type p)
+{
+	if (phaseTiming)
+		Switch (current);
+	return wall[p];
+}
+
+void Phase::AddFile (const string & name, long long bytes, double seconds)
+{
+	files.push_back (FileRecord {name, bytes, seconds});
+}
+
+/********************************************************************************/
+/* This function writes the time of each phase, the bytes written to each       */
+/* output file, the token and rule counts and the peak resident set size to     */
+/* out, as a table or as a JSON object, headed by the input file if one is     */
+/* given.                                                                       */
+/********************************************************************************/
+void Phase::Report (ostream & out, bool json, const string & input)
+{
+	if (!phaseTiming)
+		return;
+	Switch (current);
+	double totalWall = lastWall - startWall, totalCpu = lastCpu - startCpu;
+	rusage usage;
+	getrusage (RUSAGE_SELF, &usage);
+	long peak = usage.ru_maxrss;	// kilobytes
+	char line [200];
+	if (json)
+	{
+		out << '{';
+		if (!input.empty ())
+		{
+			out << "\"input\": \"";
+			for (char c : input)
+				out << (c == '"' || c == '\\' ? "\\" : "") << c;
+			out << "\", ";
+		}
+		out << "\"phases\": {";
+		for (int p = 0; p < PHASES; p++)
+		{
+			snprintf (line, sizeof (line), "%s\"%s\": {\"wall_ms\": %.3f, \"cpu_ms\": %.3f}",
+				p ? ", " : "", phase_names[p], wall[p] * 1e3, cpu[p] * 1e3);
+			out << line;
+		}
+		snprintf (line, sizeof (line), "}, \"total\": {\"wall_ms\": %.3f, \"cpu_ms\": %.3f}, \"files\": {",
+			totalWall * 1e3, totalCpu * 1e3);
+		out << line;
+		for (size_t f = 0; f < files.size (); f++)
+		{
+			out << (f ? ", " : "") << '"';
+			for (char c : files[f].name)
+				out << (c == '"' || c == '\\' ? "\\" : "") << c;
+			snprintf (line, sizeof (line), "\": {\"bytes\": %lld, \"write_ms\": %.3f}", files[f].bytes,
+				files[f].seconds * 1e3);
+			out << line;
+		}
+		snprintf (line, sizeof (line), "}, \"tokens\": %lld, \"rules\": %lld, \"peak_rss_kb\": %ld}\n",
+			tokens, rules, peak);
+		out << line;
+		return;
+	}
+	if (!input.empty ())
+		out << "Input file: " << input << endl;
+	out << "Phase          wall ms     cpu ms\n";
+	for (int p = 0; p < PHASES; p++)
+	{
+		snprintf (line, sizeof (line), "%-10s %11.3f %10.3f\n", phase_names[p], wall[p] * 1e3, cpu[p] * 1e3);
+		out << line;
+	}
+	snprintf (line, sizeof (line), "%-10s %11.3f %10.3f\n\n", "total", totalWall * 1e3, totalCpu * 1e3);
+	out << line;
+	size_t width = 11;
+	for (const FileRecord & F : files)
+		width = max (width, F.name.size ());
+	snprintf (line, sizeof (line), "%-*s %12s %10s\n", int (width), "Output file", "bytes", "write ms");
+	out << line;
+	for (const FileRecord & F : files)
+	{
+		snprintf (line, sizeof (line), "%-*s %12lld %10.3f\n", int (width), F.name.c_str (), F.bytes, F.seconds * 1e3);
+		out << line;
+	}
+	snprintf (line, sizeof (line), "\nTokens: %lld\nRules: %lld\nPeak RSS: %ld KB\n", tokens, rules, peak);
+	out << line;
+}
+
+/********************************************************************************/
+/* OutputFile writes a buffer of 64 KB at a time, or whenever it is flushed.    */
+/********************************************************************************/
+static const size_t BUFFER_SIZE = 1 << 16;
+
+bool writeBehind = false;
+
+/********************************************************************************/
+/* The background writer: one thread, shared by every OutputFile, that writes  */
+/* the full buffers handed to it in the order they were handed over. It is     */
+/* never destroyed, so it can still be waited on while the program exits.      */
+/********************************************************************************/
+class Writer
+{
+    public:
+	Writer ()
+	{
+		thread (&Writer::Run, this).detach ();
+	}
+	void Hand (OutputFile::Buffer * B)
+	{
+		lock_guard <mutex> hold (lock);
+		B->writing = true;
+		pending.push_back (B);
+		ready.notify_one ();
+	}
+	void Wait (OutputFile::Buffer * B)
+	{
+		unique_lock <mutex> hold (lock);
+		done.wait (hold, [B] { return !B->writing; });
+	}
+    private:
+	mutex lock;
+	condition_variable ready, done;
+	deque <OutputFile::Buffer *> pending;
+	void Run ()
+	{
+		while (true)
+		{
+			unique_lock <mutex> hold (lock);
+			ready.wait (hold, [this] { return !pending.empty (); });
+			OutputFile::Buffer * B = pending.front ();
+			pending.pop_front ();
+			hold.unlock ();
+			B->Write (B->spare.data (), B->spareSize);
+			hold.lock ();
+			B->writing = false;
+			done.notify_all ();
+		}
+	}
+};
+
+static Writer & Background ()
+{
+	static Writer * writer = new Writer;
+	return * writer;
+}
+
+OutputFile::Buffer::Buffer () : fd (-1), owned (false), bytes (0), lines (0), seconds (0), spareSize (0),
+	handed (false), writing (false), data (BUFFER_SIZE)
+{
+	setp (data.data (), data.data () + data.size ());
+}
+
+/********************************************************************************/
+/* This function writes size bytes of text to the file, timing the write.      */
+/********************************************************************************/
+void OutputFile::Buffer::Write (const char * text, size_t size)
+{
+	double start = Now (CLOCK_MONOTONIC);
+	for (size_t done = 0; done < size; )
+	{
+		ssize_t n = ::write (fd, text + done, size - done);
+		if (n <= 0)
+			break;
+		done += n;
+	}
+	bytes += size;
+	seconds += Now (CLOCK_MONOTONIC) - start;
+}
+
+/********************************************************************************/
+/* This function empties the buffer: it writes it to the file or, with         */
+/* writeBehind set, swaps it with the spare buffer once that has been written  */
+/* and hands it to the background writer. Only the wait for the spare buffer   */
+/* is charged to the write phase then.                                          */
+/********************************************************************************/
+void OutputFile::Buffer::Flush ()
+{
+	size_t size = pptr () - pbase ();
+	if (fd >= 0 || phaseTiming)	// without a file, lines are only counted for the report
+		lines += count (pbase (), pptr (), '\n');
+	if (size && fd >= 0 && writeBehind)
+	{
+		Wait ();
+		data.swap (spare);
+		if (data.size () < BUFFER_SIZE)
+			data.resize (BUFFER_SIZE);
+		spareSize = size;
+		handed = true;
+		Background ().Hand (this);
+	}
+	else if (size && fd >= 0)
+	{
+		Phase phase (WRITE_P);
+		Write (pbase (), size);
+	}
+	setp (data.data (), data.data () + data.size ());
+}
+
+void OutputFile::Buffer::Wait ()
+{
+	if (handed)
+	{
+		Phase phase (WRITE_P);
+		Background ().Wait (this);
+		handed = false;
+	}
+}
+
+int OutputFile::Buffer::overflow (int c)
+{
+	Flush ();
+	if (c != EOF)
+	{
+		*pptr () = c;
+		pbump (1);
+	}
+	return c == EOF ? 0 : c;
+}
+
+int OutputFile::Buffer::sync ()
+{
+	if (!writeBehind)
+		Flush ();
+	return 0;
+}
+
+OutputFile::OutputFile () : ostream (nullptr)
+{
+	rdbuf (&buffer);
+}
+
+OutputFile::~OutputFile ()
+{
+	close ();
+}
+
+/********************************************************************************/
+/* These functions open the file name, replacing what it held, or write to the  */
+/* open descriptor fd, and flush and close it. A file that cannot be opened    */
+/* leaves the stream failed; an attached descriptor is left open.               */
+/********************************************************************************/
+void OutputFile::open (const string & name)
+{
+	close ();
+	attach (::open (name.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644), name);
+	buffer.owned = true;
+}
+
+void OutputFile::attach (int fd, const string & name)
+{
+	close ();
+	buffer.fd = fd;
+	buffer.owned = false;
+	buffer.name = name;
+	buffer.bytes = buffer.lines = 0;
+	buffer.seconds = 0;
+	if (buffer.fd < 0)
+		setstate (failbit);
+	else
+		clear ();
+}
+
+void OutputFile::close ()
+{
+	if (buffer.fd < 0)
+		return;
+	buffer.Flush ();
+	buffer.Wait ();
+	if (buffer.owned)
+		::close (buffer.fd);
+	buffer.fd = -1;
+	if (phaseTiming)
+		Phase::AddFile (buffer.name, buffer.bytes, buffer.seconds);
+}
+
+/********************************************************************************/
+/* This function writes what the buffer holds now or, with writeBehind set,     */
+/* hands it to the background writer, which writes it next.                     */
+/********************************************************************************/
+void OutputFile::Send ()
+{
+	buffer.Flush ();
+}
+
+long long OutputFile::Buffer::Lines () const
+{
+	return lines + count (pbase (), pptr (), '\n');
+}
+
+long long OutputFile::Lines () const
+{
+	return buffer.Lines ();
+}
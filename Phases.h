@@ -0,0 +1,125 @@
+#ifndef PHASES_H
+#define PHASES_H
+
+/*******************************************************************************
+* Title: Phase timing for Scheme to C++ Translator                             *
+* Author: Seth Nuzum                                                           *
+* Date: 11-17-23                                                               *
+* File: Phases.h                                                               *
+*                                                                              *
+* Description: This file contains the description of the Phase timer and of   *
+*              the OutputFile stream the translator writes its files with.    *
+*******************************************************************************/
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*******************************************************************************
+* Type: phase_type                                                             *
+*                                                                              *
+* Description: The phases of a translation. The lexical analyzer, the code    *
+*              generator and the writing of the output files are timed where   *
+*              they are entered; the rest of the time is the parser's.         *
+*******************************************************************************/
+
+enum phase_type
+{
+	LEX_P, PARSE_P, GENERATE_P, WRITE_P, PHASES
+};
+
+extern thread_local bool phaseTiming;
+
+// Set by the driver: output files are written by a background thread
+extern bool writeBehind;
+
+/*******************************************************************************
+* Class: Phase                                                                 *
+*                                                                              *
+* Description: A Phase object charges the wall and CPU time from its creation  *
+*              to its deletion to its phase, and the time before and after to  *
+*              the phase it interrupted. Nothing is measured unless Start has  *
+*              been called. Each thread keeps its own times and counts.        *
+*******************************************************************************/
+
+class Phase
+{
+    public:
+	Phase (phase_type p) : previous (p)
+	{
+		if (phaseTiming)
+			previous = Switch (p);
+	}
+	~Phase ()
+	{
+		if (phaseTiming)
+			Switch (previous);
+	}
+	static void Start ();
+	static void Report (ostream & out, bool json, const string & input = "");
+	static double Seconds (phase_type p);
+	static thread_local long long tokens;	// tokens returned by the lexical analyzer
+	static thread_local long long rules;	// grammar rules used by the parser
+	static void AddFile (const string & name, long long bytes, double seconds);
+    private:
+	phase_type previous;
+	static phase_type Switch (phase_type p);
+};
+
+/*******************************************************************************
+* Class: OutputFile                                                            *
+*                                                                              *
+* Description: An output stream on a file, written through a buffer of its    *
+*              own so that the time spent writing and the bytes and lines      *
+*              written can be counted. Flushing it writes the buffer to the    *
+*              file, as flushing an ofstream does. It can also write to a      *
+*              descriptor that is already open, such as standard output.       *
+*              With writeBehind set, the buffer is doubled: a full buffer is   *
+*              handed to the background writer and the other one is filled    *
+*              meanwhile. Flushing then writes nothing; the file is complete   *
+*              once it is closed. Send writes the buffer in either case, for   *
+*              a reader waiting on the file.                                   *
+*******************************************************************************/
+
+class OutputFile : public ostream
+{
+    public:
+	OutputFile ();
+	~OutputFile ();
+	void open (const string & name);
+	void attach (int fd, const string & name);
+	void close ();
+	void Send ();
+	long long Lines () const;
+    private:
+	class Buffer : public streambuf
+	{
+	    public:
+		Buffer ();
+		int fd;
+		bool owned;	// the descriptor is closed with the file
+		string name;
+		long long bytes;
+		long long lines;
+		double seconds;
+		void Flush ();
+		void Wait ();
+		void Write (const char * text, size_t size);
+		long long Lines () const;
+		vector <char> spare;	// the buffer being written in the background
+		size_t spareSize;
+		bool handed;		// spare was handed to the writer and not waited for
+		bool writing;		// spare has not been written yet; the writer's lock guards it
+	    protected:
+		int overflow (int c) override;
+		int sync () override;
+	    private:
+		vector <char> data;
+	};
+	Buffer buffer;
+	friend class Writer;
+};
+
+#endif
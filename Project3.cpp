@@ -6,29 +6,343 @@
 *******************************************************************************/
 
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <iostream>
 #include <iomanip>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
 #include "SyntacticalAnalyzer.h"
 
-int main (int argc, char * argv[])
+/********************************************************************************/
+/* This function returns the prefix of a .pl460 file name, or an empty string  */
+/* if the name has another extension.                                          */
+/********************************************************************************/
+static string Prefix (const string & name)
 {
-	if (argc < 2)
-	{
-		cerr << "Usage: " << argv[0] << " <filename>\n";
-		exit (1);
-	}
-	cout << "Input file: " << argv[1] << endl << endl;
-	string name = argv[1];
 	string extension;
 	if (name.length() > 6)
 		extension = name.substr (name.length()-6, 6);
 	if (extension != ".pl460")
 	{
 		cout << "Invalid file extension; must be '.pl460'\n";
+		return "";
+	}
+	return name.substr (0, name.length()-6);
+}
+
+static double Now (clockid_t clock)
+{
+	timespec t;
+	clock_gettime (clock, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/********************************************************************************/
+/* This function runs a command and returns its exit status.                   */
+/********************************************************************************/
+static int Command (const vector <string> & command)
+{
+	vector <char *> args;
+	for (const string & arg : command)
+		args.push_back (const_cast <char *> (arg.c_str ()));
+	args.push_back (NULL);
+	cout.flush ();
+	pid_t child = fork ();
+	if (child == 0)
+	{
+		execvp (args[0], args.data ());
+		_exit (127);
+	}
+	int status = -1;
+	if (child < 0 || waitpid (child, &status, 0) < 0)
+		return -1;
+	return WIFEXITED (status) ? WEXITSTATUS (status) : -1;
+}
+
+/********************************************************************************/
+/* This function translates the program prefix.pl460 and, if run is set,       */
+/* compiles it with Object.o and runs it, as run1 does. It reports the time of */
+/* each step and, after a change, the time from the save of the file to the    */
+/* end.                                                                         */
+/********************************************************************************/
+static void Translate (const string & prefix, bool run, bool changed)
+{
+	struct stat info;
+	double saved = stat ((prefix + ".pl460").c_str (), &info) == 0 ?
+		info.st_mtim.tv_sec + info.st_mtim.tv_nsec * 1e-9 : Now (CLOCK_REALTIME);
+	double start = Now (CLOCK_MONOTONIC);
+	{
+		SyntacticalAnalyzer parser (prefix);
+	}
+	double translated = Now (CLOCK_MONOTONIC);
+	char report [200];
+	snprintf (report, sizeof (report), "%s.pl460: translated in %.1f ms", prefix.c_str (), (translated - start) * 1e3);
+	string text = report;
+	if (run)
+	{
+		string program = prefix.find ('/') == string::npos ? "./" + prefix : prefix;
+		int status = Command ({"g++", "-I.", prefix + ".cpp", "Object.o", "-o", prefix});
+		double compiled = Now (CLOCK_MONOTONIC);
+		snprintf (report, sizeof (report), ", compiled in %.1f ms", (compiled - translated) * 1e3);
+		text += report;
+		if (status == 0)
+		{
+			status = Command ({program});
+			snprintf (report, sizeof (report), ", ran in %.1f ms (exit status %d)",
+				(Now (CLOCK_MONOTONIC) - compiled) * 1e3, status);
+			text += report;
+		}
+		else
+			text += " with errors";
+	}
+	if (changed)
+	{
+		snprintf (report, sizeof (report), "; %.1f ms after the save", (Now (CLOCK_REALTIME) - saved) * 1e3);
+		text += report;
+	}
+	cerr << text << endl;
+}
+
+/********************************************************************************/
+/* This function translates the files once, then watches their directories    */
+/* with inotify and translates each file again whenever it is written or       */
+/* replaced. Events that arrive together are handled once per file.            */
+/********************************************************************************/
+static void Watch (const vector <string> & prefixes, bool run)
+{
+	int watcher = inotify_init1 (IN_CLOEXEC);
+	if (watcher < 0)
+	{
+		perror ("inotify_init1");
+		exit (1);
+	}
+	map <pair <int, string>, string> files;	// (watch, file name) to prefix
+	for (const string & prefix : prefixes)
+	{
+		size_t slash = prefix.rfind ('/');
+		string directory = slash == string::npos ? "." : prefix.substr (0, slash + 1);
+		string name = prefix.substr (slash == string::npos ? 0 : slash + 1) + ".pl460";
+		int watch = inotify_add_watch (watcher, directory.c_str (), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (watch < 0)
+		{
+			perror (directory.c_str ());
+			exit (1);
+		}
+		files[make_pair (watch, name)] = prefix;
+		Translate (prefix, run, false);
+	}
+	cerr << "Watching " << prefixes.size () << (prefixes.size () == 1 ? " file" : " files") << endl;
+	alignas (inotify_event) char events [4096];
+	while (true)
+	{
+		set <string> changed;
+		pollfd ready = {watcher, POLLIN, 0};
+		int timeout = -1;	// wait for the first event, then 20 ms more for the rest of a save
+		while (poll (&ready, 1, timeout) > 0)
+		{
+			ssize_t length = read (watcher, events, sizeof (events));
+			if (length <= 0)
+				break;
+			for (char * e = events; e < events + length; )
+			{
+				inotify_event * event = (inotify_event *) e;
+				if (event->len)
+				{
+					auto F = files.find (make_pair (event->wd, string (event->name)));
+					if (F != files.end ())
+						changed.insert (F->second);
+				}
+				e += sizeof (inotify_event) + event->len;
+			}
+			timeout = 20;
+		}
+		for (const string & prefix : changed)
+			Translate (prefix, run, true);
+	}
+}
+
+/********************************************************************************/
+/* This function translates the files on a pool of jobs threads. Each thread   */
+/* takes the next file that no thread has taken; a translation shares nothing  */
+/* with the others but read-only tables. What each translation would print is  */
+/* held until the translations of the files before it have been printed, so    */
+/* the output is in the order of the files. It returns the number of files    */
+/* that could not be read.                                                     */
+/********************************************************************************/
+static int Batch (const vector <string> & prefixes, unsigned jobs, bool timing, bool json)
+{
+	size_t count = prefixes.size (), printed = 0;
+	vector <string> outputs (count), reports (count);
+	vector <bool> done (count);
+	atomic <size_t> next (0);
+	atomic <int> missing (0);
+	mutex lock;
+	auto work = [&] ()
+	{
+		for (size_t i; (i = next++) < count; )
+		{
+			ostringstream output, report;
+			output << "Input file: " << prefixes[i] << ".pl460" << endl << endl;
+			if (access ((prefixes[i] + ".pl460").c_str (), R_OK) != 0)
+			{
+				output << "File " << prefixes[i] << ".pl460 not found\n";
+				missing++;
+			}
+			else
+			{
+				if (timing)
+					Phase::Start ();
+				{
+					SyntacticalAnalyzer parser (prefixes[i], output);
+				}
+				Phase::Report (report, json, prefixes[i] + ".pl460");
+			}
+			lock_guard <mutex> hold (lock);
+			outputs[i] = output.str ();
+			reports[i] = report.str ();
+			done[i] = true;
+			for (; printed < count && done[printed]; printed++)
+			{
+				cout << outputs[printed];
+				cerr << reports[printed];
+				outputs[printed].clear ();
+				reports[printed].clear ();
+			}
+			cout.flush ();
+		}
+	};
+	vector <thread> pool;
+	for (unsigned j = 1; j < min (size_t (jobs), count); j++)
+		pool.emplace_back (work);
+	work ();
+	for (thread & T : pool)
+		T.join ();
+	return missing;
+}
+
+/********************************************************************************/
+/* This function adds the .pl460 files in directory to files, in order of     */
+/* name. It returns false if directory is not one.                             */
+/********************************************************************************/
+static bool AddDirectory (const string & directory, vector <string> & files)
+{
+	DIR * dir = opendir (directory.c_str ());
+	if (!dir)
+		return false;
+	vector <string> names;
+	while (dirent * entry = readdir (dir))
+	{
+		string name = entry->d_name;
+		if (name.length() > 6 && name.compare (name.length()-6, 6, ".pl460") == 0)
+			names.push_back (directory + (directory.back () == '/' ? "" : "/") + name);
+	}
+	closedir (dir);
+	sort (names.begin (), names.end ());
+	files.insert (files.end (), names.begin (), names.end ());
+	return true;
+}
+
+int main (int argc, char * argv[])
+{
+	// --time-phases reports the time of each phase on cerr; --time-phases=json as JSON.
+	// --watch translates the files named again whenever they change; --run also
+	// compiles and runs them. Several files, or directories of them, are translated
+	// on --jobs threads, by default one per processor. --stream translates the
+	// program on standard input to C++ on standard output as it is read.
+	// --pipeline scans each program, and writes its C++ code, on threads of
+	// their own while it is parsed. The output files are written by a
+	// background thread, a buffer at a time; --sync-writes writes them on the
+	// translating thread and flushes the listing and debug files at each line,
+	// so that they are complete up to the point of a crash.
+	bool timing = false, json = false, watch = false, run = false, stream = false, sync = false;
+	unsigned jobs = max (1u, thread::hardware_concurrency ());
+	int arg = 1;
+	for (; arg < argc && string (argv[arg]).compare (0, 2, "--") == 0; arg++)
+	{
+		string option = argv[arg];
+		if (option.compare (0, 13, "--time-phases") == 0)
+		{
+			timing = true;
+			json = option == "--time-phases=json";
+		}
+		else if (option == "--watch")
+			watch = true;
+		else if (option == "--run")
+			run = true;
+		else if (option == "--stream")
+			stream = true;
+		else if (option == "--pipeline")
+			pipelined = true;
+		else if (option == "--sync-writes")
+			sync = true;
+		else if (option == "--jobs" && arg + 1 < argc && atoi (argv[arg + 1]) > 0)
+			jobs = atoi (argv[++arg]);
+		else
+			arg = argc;
+	}
+	if ((arg >= argc) != stream || (!watch && run) || (stream && watch))
+	{
+		cerr << "Usage: " << argv[0] << " [--time-phases[=json]] [--pipeline] [--sync-writes] [--jobs N] <filename or directory>...\n"
+			<< "       " << argv[0] << " --watch [--run] [--pipeline] <filename>...\n"
+			<< "       " << argv[0] << " --stream [--time-phases[=json]] [--pipeline] < program.pl460 > program.cpp\n";
 		exit (1);
 	}
-	name = name.substr (0, name.length()-6);
-	SyntacticalAnalyzer parser (name);
-	return 0;
+	writeBehind = !sync;
+	if (stream)
+	{
+		// The error count goes to cerr, as standard output holds the C++ code
+		ios::sync_with_stdio (false);
+		if (timing)
+			Phase::Start ();
+		{
+			SyntacticalAnalyzer parser (cin, STDOUT_FILENO, cerr);
+		}
+		Phase::Report (cerr, json);
+		return 0;
+	}
+	vector <string> files;
+	bool directories = false;
+	for (; arg < argc; arg++)
+		if (watch || !AddDirectory (argv[arg], files))
+			files.push_back (argv[arg]);
+		else
+			directories = true;
+	if (!watch && !directories && files.size () == 1)
+	{
+		cout << "Input file: " << files[0] << endl << endl;
+		string name = Prefix (files[0]);
+		if (name.empty ())
+			exit (1);
+		if (timing)
+			Phase::Start ();
+		{
+			SyntacticalAnalyzer parser (name);
+		}
+		Phase::Report (cerr, json);
+		return 0;
+	}
+	vector <string> prefixes;
+	for (const string & file : files)
+	{
+		string prefix = Prefix (file);
+		if (prefix.empty ())
+			exit (1);
+		prefixes.push_back (prefix);
+	}
+	if (watch)
+		Watch (prefixes, run);
+	return Batch (prefixes, jobs, timing, json) ? 2 : 0;
 }
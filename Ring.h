@@ -0,0 +1,70 @@
+#ifndef RING_H
+#define RING_H
+
+/*******************************************************************************
+* Title: Ring buffer for Scheme to C++ Translator                              *
+* Author: Seth Nuzum                                                           *
+* Date: 11-17-23                                                               *
+* File: Ring.h                                                                 *
+*                                                                              *
+* Description: This file contains the Ring, which carries tokens from the     *
+*              lexical analyzer to the parser, and generated code from the     *
+*              code generator to the writer, when a translation is pipelined.  *
+*******************************************************************************/
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+using namespace std;
+
+// Set by the driver: each translation scans and writes on threads of its own
+extern bool pipelined;
+
+/*******************************************************************************
+* Class: Ring                                                                  *
+*                                                                              *
+* Description: A queue of N slots between one producer thread and one         *
+*              consumer thread, without locks. The producer fills the slot     *
+*              Back returns and publishes it with Push; the consumer reads     *
+*              the slot Front returns and gives it back with Pop. Slots are    *
+*              reused, so what they hold keeps its storage. Back and Front     *
+*              wait, yielding the processor, while the ring is full or empty.  *
+*******************************************************************************/
+
+template <class T, size_t N> class Ring
+{
+    public:
+	Ring () : head (0), tail (0) {}
+	T & Back ()
+	{
+		size_t h = head.load (memory_order_relaxed);
+		while (h - tail.load (memory_order_acquire) == N)
+			this_thread::yield ();
+		return slots[h % N];
+	}
+	void Push ()
+	{
+		head.store (head.load (memory_order_relaxed) + 1, memory_order_release);
+	}
+	bool Empty () const
+	{
+		return head.load (memory_order_acquire) == tail.load (memory_order_relaxed);
+	}
+	T & Front ()
+	{
+		while (Empty ())
+			this_thread::yield ();
+		return slots[tail.load (memory_order_relaxed) % N];
+	}
+	void Pop ()
+	{
+		tail.store (tail.load (memory_order_relaxed) + 1, memory_order_release);
+	}
+    private:
+	T slots [N];
+	alignas (64) atomic <size_t> head;	// slots published by the producer
+	alignas (64) atomic <size_t> tail;	// slots given back by the consumer
+};
+
+#endif
@@ -15,12 +15,13 @@
 #include <iomanip>
 #include <fstream>
 #include <cstring>
+#include <cctype>
 #include <set>
 #include "SyntacticalAnalyzer.h"
 
 using namespace std;
 
-static string token_lexemes[] = {
+static const string token_lexemes[] = {
 	"{}",
 	"identifier",
 	"numeric literal",
@@ -59,12 +60,35 @@ static string token_lexemes[] = {
 	"round",
 	"read",
 	"else",
+	"make-hash-table",
+	"hash-ref",
+	"hash-set!",
+	"hash-count",
+	"make-vector",
+	"vector-ref",
+	"vector-set!",
+	"vector-length",
+	"#(",
 	"string literal",
 	"error",
 	"end of file",
 	"end of file",
 };
 
+// The forms translated to calls of the runtime functions that implement them
+static const set<int> runtimeForms{MAKEHASH_T, HASHREF_T, HASHSET_T, HASHCOUNT_T,
+					MAKEVECTOR_T, VECTORREF_T, VECTORSET_T, VECTORLENGTH_T};
+
+// The C++ variable for the number'th let binding of a define, which binds name;
+// the number keeps it apart from every other variable of the define
+static string variable(const string & name, int number)
+{
+	string text;
+	for (char c : name)
+		text += isalnum((unsigned char) c) ? c : '_';
+	return text + "_" + to_string(number);
+}
+
 /**********************************************************************
  * Function: SyntacticalAnalyzer::SyntacticalAnalyzer
  * --------------------------------------------------------------------
@@ -76,15 +100,45 @@ static string token_lexemes[] = {
  * Parameters:
  *    - fileNamePrefix: A string reference representing the prefix for 
  *                      the file names used in the analysis process.
+ *    - messages: The stream the error count is reported on.
  * --------------------------------------------------------------------
  * Returns: None (Constructor)
  **********************************************************************/
 
-SyntacticalAnalyzer::SyntacticalAnalyzer(const string &fileNamePrefix)
+SyntacticalAnalyzer::SyntacticalAnalyzer(const string &fileNamePrefix, ostream &messages)
 {
 	ruleFile.open(fileNamePrefix + ".p2");
-	lex = new LexicalAnalyzer(fileNamePrefix);
+	lex = new LexicalAnalyzer(fileNamePrefix, messages);
 	cg = new CodeGenerator(fileNamePrefix, lex); // Added for Project 3
+	place = NESTED;
+	indent = 1;
+	token = lex->GetToken();
+	program();
+}
+
+/**********************************************************************
+ * Function: SyntacticalAnalyzer::SyntacticalAnalyzer
+ * --------------------------------------------------------------------
+ * Purpose: Constructs a SyntacticalAnalyzer that translates the program
+ *          read from input as it arrives, writing the C++ code to the
+ *          descriptor output and no other files. Each define is
+ *          written when it ends, so memory does not grow with the
+ *          length of the program.
+ * --------------------------------------------------------------------
+ * Parameters:
+ *    - input: The stream the program is read from.
+ *    - output: The open descriptor the C++ code is written to.
+ *    - messages: The stream the error count is reported on.
+ * --------------------------------------------------------------------
+ * Returns: None (Constructor)
+ **********************************************************************/
+
+SyntacticalAnalyzer::SyntacticalAnalyzer(istream &input, int output, ostream &messages)
+{
+	lex = new LexicalAnalyzer(input, messages);
+	cg = new CodeGenerator(output, lex);
+	place = NESTED;
+	indent = 1;
 	token = lex->GetToken();
 	program();
 }
@@ -93,6 +147,7 @@ SyntacticalAnalyzer::SyntacticalAnalyzer(const string &fileNamePrefix)
 //Destructor: 
 SyntacticalAnalyzer::~SyntacticalAnalyzer()
 {
+	Phase::rules = ruleFile.Lines(); // the .p2 file has a line per rule used
 	ruleFile.close();
 	delete cg; // Added for Project 3
 	delete lex;
@@ -114,8 +169,8 @@ SyntacticalAnalyzer::~SyntacticalAnalyzer()
 void SyntacticalAnalyzer::program()
 {
 	int errors = 0;
-	set<int> firsts{LPAREN_T, EOF_T};
-	set<int> follows{EOF_T};
+	static const set<int> firsts{LPAREN_T, EOF_T};
+	static const set<int> follows{EOF_T};
 
 	char message[100];
 	sprintf(message, "Entering Program function; current token is: %s, lexeme: %s", lex->GetTokenName(token).c_str(), lex->GetLexeme().c_str());
@@ -193,8 +248,8 @@ void SyntacticalAnalyzer::program()
 void SyntacticalAnalyzer::more_defines()
 {
 	int errors = 0;
-	set<int> firsts{DEFINE_T, IDENT_T, EOF_T};
-	set<int> follows{EOF_T, EOF_T};
+	static const set<int> firsts{DEFINE_T, IDENT_T, EOF_T};
+	static const set<int> follows{EOF_T, EOF_T};
 
 	char message[100];
 	sprintf(message, "Entering More_Defines function; current token is: %s, lexeme: %s", lex->GetTokenName(token).c_str(), lex->GetLexeme().c_str());
@@ -208,7 +263,9 @@ void SyntacticalAnalyzer::more_defines()
 		while (firsts.find(token) == firsts.end())
 			token = lex->GetToken();
 	}
-	if (token == DEFINE_T)
+	// Rule 2 is applied once per define; a loop, so that the stack does not
+	// grow with the number of defines
+	while (token == DEFINE_T)
 	{ // Rule 2
 		lex->debugFile << "Using Rule 2\n";
 		ruleFile << "Using Rule 2\n";
@@ -223,9 +280,16 @@ void SyntacticalAnalyzer::more_defines()
 			sprintf(message, "'%s' expected ", token_lexemes[LPAREN_T].c_str());
 			lex->ReportError(message);
 		}
-		more_defines();
+		if (firsts.find(token) == firsts.end())
+		{
+			errors++;
+			sprintf(message, "'%s' unexpected ", lex->GetLexeme().c_str());
+			lex->ReportError(message);
+			while (firsts.find(token) == firsts.end())
+				token = lex->GetToken();
+		}
 	}
-	else if (token == IDENT_T)
+	if (token == IDENT_T)
 	{ // Rule 3
 		lex->debugFile << "Using Rule 3\n";
 		ruleFile << "Using Rule 3\n";
@@ -277,8 +341,8 @@ void SyntacticalAnalyzer::more_defines()
 void SyntacticalAnalyzer::define()
 {
 	int errors = 0;
-	set<int> firsts{DEFINE_T, EOF_T};
-	set<int> follows{LPAREN_T, EOF_T};
+	static const set<int> firsts{DEFINE_T, EOF_T};
+	static const set<int> follows{LPAREN_T, EOF_T};
 
 	char message[100];
 	sprintf(message, "Entering Define function; current token is: %s, lexeme: %s", lex->GetTokenName(token).c_str(), lex->GetLexeme().c_str());
@@ -304,35 +368,46 @@ void SyntacticalAnalyzer::define()
 			if (token == IDENT_T)
 			{
 				string functionName = lex->GetLexeme();
-				cg->WriteCode(0, "int " + functionName + "() {\n");
+				cg->BeginFunction("int " + functionName + "() {\n");
+				allocates = false;
+				escapes = false;
+				bindings = 0;
+				indent = 1;
 				token = lex->GetToken();
+				param_list(); // the parameters are not translated yet
 
 				if (token == RPAREN_T)
 				{
 					token = lex->GetToken();
-					// Begin parsing the function body
-					while (token != EOF_T)
+					// Each statement of the body is parsed, up to the ')' that
+					// ends the define
+					while (token != RPAREN_T && token != EOF_T)
 					{
-						if (token == RPAREN_T)
-						{
-							// Detect the end of the function body
-							break;
-						}
-
-						// Debugging statement
-
+						place = STATEMENT;
 						stmt(); // Process each statement
-
-						token = lex->GetToken();
 					}
+					place = NESTED;
 
 					cg->WriteCode(0, "}\n\n"); // Close the function body
+					// main's activation is the whole run, so a region would free nothing early
+					cg->EndFunction(allocates && !escapes && functionName != "main");
+					if (token == RPAREN_T)
+					{
+						token = lex->GetToken();
+					}
+					else
+					{
+						errors++;
+						sprintf(message, "'%s' expected ", token_lexemes[RPAREN_T].c_str());
+						lex->ReportError(message);
+					}
 				}
 				else
 				{
 					errors++;
 					sprintf(message, "')' expected after function parameters");
 					lex->ReportError(message);
+					cg->EndFunction(false);
 				}
 			}
 			else
@@ -384,9 +459,9 @@ void SyntacticalAnalyzer::define()
 void SyntacticalAnalyzer::stmt_list()
 {
 	int errors = 0;
-	set<int> firsts{NUMLIT_T, TRUE_T, FALSE_T, LPAREN_T, SQUOTE_T, IDENT_T,
-					STRLIT_T, RPAREN_T, EOF_T};
-	set<int> follows{RPAREN_T, EOF_T};
+	static const set<int> firsts{NUMLIT_T, TRUE_T, FALSE_T, LPAREN_T, SQUOTE_T, IDENT_T,
+					STRLIT_T, VECTOR_T, RPAREN_T, EOF_T};
+	static const set<int> follows{RPAREN_T, EOF_T};
 
 	char message[100];
 	sprintf(message, "Entering Stmt_List function; current token is: %s, lexeme: %s", lex->GetTokenName(token).c_str(), lex->GetLexeme().c_str());
@@ -400,11 +475,13 @@ void SyntacticalAnalyzer::stmt_list()
 		while (firsts.find(token) == firsts.end())
 			token = lex->GetToken();
 	}
-	if (token == NUMLIT_T || token == TRUE_T || token == FALSE_T || token == LPAREN_T || token == SQUOTE_T || token == IDENT_T || token == STRLIT_T)
+	Place where = place; // each statement of the list is used as the list is
+	if (token == NUMLIT_T || token == TRUE_T || token == FALSE_T || token == LPAREN_T || token == SQUOTE_T || token == IDENT_T || token == STRLIT_T || token == VECTOR_T)
 	{ // Rule 5
 		lex->debugFile << "Using Rule 5\n";
 		ruleFile << "Using Rule 5\n";
 		stmt();
+		place = where;
 		stmt_list();
 	}
 	else if (token == RPAREN_T)
@@ -449,8 +526,8 @@ void SyntacticalAnalyzer::stmt_list()
 void SyntacticalAnalyzer::stmt()
 {
 	int errors = 0;
-	set<int> firsts{NUMLIT_T, TRUE_T, FALSE_T, SQUOTE_T, STRLIT_T, IDENT_T, LPAREN_T, EOF_T};
-	set<int> follows{NUMLIT_T, TRUE_T, FALSE_T, LPAREN_T, RPAREN_T, SQUOTE_T, IDENT_T, STRLIT_T, EOF_T};
+	static const set<int> firsts{NUMLIT_T, TRUE_T, FALSE_T, SQUOTE_T, STRLIT_T, VECTOR_T, IDENT_T, LPAREN_T, EOF_T};
+	static const set<int> follows{NUMLIT_T, TRUE_T, FALSE_T, LPAREN_T, RPAREN_T, SQUOTE_T, IDENT_T, STRLIT_T, VECTOR_T, EOF_T};
 
 	char message[100];
 	sprintf(message, "Entering Stmt function; current token is: %s, lexeme: %s", lex->GetTokenName(token).c_str(), lex->GetLexeme().c_str());
@@ -465,6 +542,19 @@ void SyntacticalAnalyzer::stmt()
 			token = lex->GetToken();
 	}
 
+	if (token == NUMLIT_T || token == STRLIT_T || token == SQUOTE_T || token == TRUE_T || token == FALSE_T || token == VECTOR_T)
+	{ // Rule 7
+		lex->debugFile << "Using Rule 7\n";
+		ruleFile << "Using Rule 7\n";
+		literal();
+	}
+	else if (token == IDENT_T)
+	{ // Rule 8
+		lex->debugFile << "Using Rule 8\n";
+		ruleFile << "Using Rule 8\n";
+		token = lex->GetToken();
+	}
+	Place where = place; // each form read here is used as the statement is
 	while (token == LPAREN_T)
 	{
 		lex->debugFile << "Using Rule 9\n";
@@ -472,6 +562,7 @@ void SyntacticalAnalyzer::stmt()
 		token = lex->GetToken();
 
 		//Calling action function here: 
+		place = where;
 		action();
 		
 
@@ -507,8 +598,8 @@ void SyntacticalAnalyzer::stmt()
  * Purpose: Handles the parsing and translation of 
  *          literal values in a PL460 program. This 
  *          function deals with numeric literals, 
- *          string literals, quoted literals, and 
- *          boolean literals.
+ *          string literals, quoted literals, 
+ *          boolean literals and vector literals.
  * --------------------------------------------------
  * Parameters: None
  * --------------------------------------------------
@@ -518,9 +609,9 @@ void SyntacticalAnalyzer::stmt()
 void SyntacticalAnalyzer::literal()
 {
 	int errors = 0;
-	set<int> firsts{NUMLIT_T, STRLIT_T, SQUOTE_T, TRUE_T, FALSE_T, EOF_T};
-	set<int> follows{NUMLIT_T, TRUE_T, FALSE_T, LPAREN_T, RPAREN_T, SQUOTE_T,
-					 IDENT_T, STRLIT_T, EOF_T};
+	static const set<int> firsts{NUMLIT_T, STRLIT_T, SQUOTE_T, TRUE_T, FALSE_T, VECTOR_T, EOF_T};
+	static const set<int> follows{NUMLIT_T, TRUE_T, FALSE_T, LPAREN_T, RPAREN_T, SQUOTE_T,
+					 IDENT_T, STRLIT_T, VECTOR_T, EOF_T};
 
 	char message[100];
 	sprintf(message, "Entering Literal function; current token is: %s, lexeme: %s", lex->GetTokenName(token).c_str(), lex->GetLexeme().c_str());
@@ -559,6 +650,23 @@ void SyntacticalAnalyzer::literal()
 		ruleFile << "Using Rule 13\n";
 		logical_lit();
 	}
+	else if (token == VECTOR_T)
+	{ // Rule 106
+		lex->debugFile << "Using Rule 106\n";
+		ruleFile << "Using Rule 106\n";
+		token = lex->GetToken();
+		more_tokens();
+		if (token == RPAREN_T)
+		{
+			token = lex->GetToken();
+		}
+		else
+		{
+			errors++;
+			sprintf(message, "'%s' expected ", token_lexemes[RPAREN_T].c_str());
+			lex->ReportError(message);
+		}
+	}
 	else
 	{
 		errors++;
@@ -600,15 +708,18 @@ void SyntacticalAnalyzer::literal()
 void SyntacticalAnalyzer::quoted_lit()
 {
 	int errors = 0;
-	set<int> firsts{NUMLIT_T, LISTOP1_T, PLUS_T, MINUS_T, GT_T, LT_T,
+	static const set<int> firsts{NUMLIT_T, LISTOP1_T, PLUS_T, MINUS_T, GT_T, LT_T,
 					TRUE_T, FALSE_T, DIV_T, MULT_T, EQUALTO_T, GTE_T,
 					LTE_T, LPAREN_T, SQUOTE_T, IDENT_T, IF_T, COND_T,
 					DISPLAY_T, NEWLINE_T, AND_T, OR_T, NOT_T, DEFINE_T,
 					LET_T, LISTOP2_T, NUMBERP_T, LISTP_T, ZEROP_T, NULLP_T,
 					EOFP_T, MODULO_T, ROUND_T, READ_T, ELSE_T, STRLIT_T,
+					MAKEHASH_T, HASHREF_T, HASHSET_T, HASHCOUNT_T,
+					MAKEVECTOR_T, VECTORREF_T, VECTORSET_T, VECTORLENGTH_T,
+					VECTOR_T,
 					EOF_T};
-	set<int> follows{NUMLIT_T, TRUE_T, FALSE_T, LPAREN_T, RPAREN_T, SQUOTE_T,
-					 IDENT_T, STRLIT_T, EOF_T};
+	static const set<int> follows{NUMLIT_T, TRUE_T, FALSE_T, LPAREN_T, RPAREN_T, SQUOTE_T,
+					 IDENT_T, STRLIT_T, VECTOR_T, EOF_T};
 
 	char message[100];
 	sprintf(message, "Entering Quoted_Lit function; current token is: %s, lexeme: %s", lex->GetTokenName(token).c_str(), lex->GetLexeme().c_str());
@@ -622,7 +733,7 @@ void SyntacticalAnalyzer::quoted_lit()
 		while (firsts.find(token) == firsts.end())
 			token = lex->GetToken();
 	}
-	if (token == NUMLIT_T || token == LISTOP1_T || token == PLUS_T || token == MINUS_T || token == GT_T || token == LT_T || token == TRUE_T || token == FALSE_T || token == DIV_T || token == MULT_T || token == EQUALTO_T || token == GTE_T || token == LTE_T || token == LPAREN_T || token == SQUOTE_T || token == IDENT_T || token == IF_T || token == COND_T || token == DISPLAY_T || token == NEWLINE_T || token == AND_T || token == OR_T || token == NOT_T || token == DEFINE_T || token == LET_T || token == LISTOP2_T || token == NUMBERP_T || token == LISTP_T || token == ZEROP_T || token == NULLP_T || token == EOFP_T || token == MODULO_T || token == ROUND_T || token == READ_T || token == ELSE_T || token == STRLIT_T)
+	if (token == NUMLIT_T || token == LISTOP1_T || token == PLUS_T || token == MINUS_T || token == GT_T || token == LT_T || token == TRUE_T || token == FALSE_T || token == DIV_T || token == MULT_T || token == EQUALTO_T || token == GTE_T || token == LTE_T || token == LPAREN_T || token == SQUOTE_T || token == IDENT_T || token == IF_T || token == COND_T || token == DISPLAY_T || token == NEWLINE_T || token == AND_T || token == OR_T || token == NOT_T || token == DEFINE_T || token == LET_T || token == LISTOP2_T || token == NUMBERP_T || token == LISTP_T || token == ZEROP_T || token == NULLP_T || token == EOFP_T || token == MODULO_T || token == ROUND_T || token == READ_T || token == ELSE_T || token == MAKEHASH_T || token == HASHREF_T || token == HASHSET_T || token == HASHCOUNT_T || token == MAKEVECTOR_T || token == VECTORREF_T || token == VECTORSET_T || token == VECTORLENGTH_T || token == VECTOR_T || token == STRLIT_T)
 	{ // Rule 14
 		lex->debugFile << "Using Rule 14\n";
 		ruleFile << "Using Rule 14\n";
@@ -668,9 +779,9 @@ void SyntacticalAnalyzer::quoted_lit()
 void SyntacticalAnalyzer::logical_lit()
 {
 	int errors = 0;
-	set<int> firsts{TRUE_T, FALSE_T, EOF_T};
-	set<int> follows{NUMLIT_T, TRUE_T, FALSE_T, LPAREN_T, RPAREN_T, SQUOTE_T,
-					 IDENT_T, STRLIT_T, EOF_T};
+	static const set<int> firsts{TRUE_T, FALSE_T, EOF_T};
+	static const set<int> follows{NUMLIT_T, TRUE_T, FALSE_T, LPAREN_T, RPAREN_T, SQUOTE_T,
+					 IDENT_T, STRLIT_T, VECTOR_T, EOF_T};
 
 	char message[100];
 	sprintf(message, "Entering Logical_Lit function; current token is: %s, lexeme: %s", lex->GetTokenName(token).c_str(), lex->GetLexeme().c_str());
@@ -719,14 +830,17 @@ void SyntacticalAnalyzer::logical_lit()
 void SyntacticalAnalyzer::more_tokens()
 {
 	int errors = 0;
-	set<int> firsts{NUMLIT_T, LISTOP1_T, PLUS_T, MINUS_T, GT_T, LT_T,
+	static const set<int> firsts{NUMLIT_T, LISTOP1_T, PLUS_T, MINUS_T, GT_T, LT_T,
 					TRUE_T, FALSE_T, DIV_T, MULT_T, EQUALTO_T, GTE_T,
 					LTE_T, LPAREN_T, SQUOTE_T, IDENT_T, IF_T, COND_T,
 					DISPLAY_T, NEWLINE_T, AND_T, OR_T, NOT_T, DEFINE_T,
 					LET_T, LISTOP2_T, NUMBERP_T, LISTP_T, ZEROP_T, NULLP_T,
 					EOFP_T, MODULO_T, ROUND_T, READ_T, ELSE_T, STRLIT_T,
+					MAKEHASH_T, HASHREF_T, HASHSET_T, HASHCOUNT_T,
+					MAKEVECTOR_T, VECTORREF_T, VECTORSET_T, VECTORLENGTH_T,
+					VECTOR_T,
 					RPAREN_T, EOF_T};
-	set<int> follows{RPAREN_T, EOF_T};
+	static const set<int> follows{RPAREN_T, EOF_T};
 
 	char message[100];
 	sprintf(message, "Entering More_Tokens function; current token is: %s, lexeme: %s", lex->GetTokenName(token).c_str(), lex->GetLexeme().c_str());
@@ -740,7 +854,7 @@ void SyntacticalAnalyzer::more_tokens()
 		while (firsts.find(token) == firsts.end())
 			token = lex->GetToken();
 	}
-	if (token == NUMLIT_T || token == LISTOP1_T || token == PLUS_T || token == MINUS_T || token == GT_T || token == LT_T || token == TRUE_T || token == FALSE_T || token == DIV_T || token == MULT_T || token == EQUALTO_T || token == GTE_T || token == LTE_T || token == LPAREN_T || token == SQUOTE_T || token == IDENT_T || token == IF_T || token == COND_T || token == DISPLAY_T || token == NEWLINE_T || token == AND_T || token == OR_T || token == NOT_T || token == DEFINE_T || token == LET_T || token == LISTOP2_T || token == NUMBERP_T || token == LISTP_T || token == ZEROP_T || token == NULLP_T || token == EOFP_T || token == MODULO_T || token == ROUND_T || token == READ_T || token == ELSE_T || token == STRLIT_T)
+	if (token == NUMLIT_T || token == LISTOP1_T || token == PLUS_T || token == MINUS_T || token == GT_T || token == LT_T || token == TRUE_T || token == FALSE_T || token == DIV_T || token == MULT_T || token == EQUALTO_T || token == GTE_T || token == LTE_T || token == LPAREN_T || token == SQUOTE_T || token == IDENT_T || token == IF_T || token == COND_T || token == DISPLAY_T || token == NEWLINE_T || token == AND_T || token == OR_T || token == NOT_T || token == DEFINE_T || token == LET_T || token == LISTOP2_T || token == NUMBERP_T || token == LISTP_T || token == ZEROP_T || token == NULLP_T || token == EOFP_T || token == MODULO_T || token == ROUND_T || token == READ_T || token == ELSE_T || token == MAKEHASH_T || token == HASHREF_T || token == HASHSET_T || token == HASHCOUNT_T || token == MAKEVECTOR_T || token == VECTORREF_T || token == VECTORSET_T || token == VECTORLENGTH_T || token == VECTOR_T || token == STRLIT_T)
 	{ // Rule 17
 		lex->debugFile << "Using Rule 17\n";
 		ruleFile << "Using Rule 17\n";
@@ -793,8 +907,8 @@ void SyntacticalAnalyzer::more_tokens()
 void SyntacticalAnalyzer::param_list()
 {
 	int errors = 0;
-	set<int> firsts{IDENT_T, RPAREN_T, EOF_T};
-	set<int> follows{RPAREN_T, EOF_T};
+	static const set<int> firsts{IDENT_T, RPAREN_T, EOF_T};
+	static const set<int> follows{RPAREN_T, EOF_T};
 
 	char message[100];
 	sprintf(message, "Entering Param_List function; current token is: %s, lexeme: %s", lex->GetTokenName(token).c_str(), lex->GetLexeme().c_str());
@@ -859,9 +973,9 @@ void SyntacticalAnalyzer::param_list()
 void SyntacticalAnalyzer::else_part()
 {
 	int errors = 0;
-	set<int> firsts{NUMLIT_T, TRUE_T, FALSE_T, LPAREN_T, SQUOTE_T, IDENT_T,
-					STRLIT_T, RPAREN_T, EOF_T};
-	set<int> follows{RPAREN_T, EOF_T};
+	static const set<int> firsts{NUMLIT_T, TRUE_T, FALSE_T, LPAREN_T, SQUOTE_T, IDENT_T,
+					STRLIT_T, VECTOR_T, RPAREN_T, EOF_T};
+	static const set<int> follows{RPAREN_T, EOF_T};
 
 	char message[100];
 	sprintf(message, "Entering Else_Part function; current token is: %s, lexeme: %s", lex->GetTokenName(token).c_str(), lex->GetLexeme().c_str());
@@ -875,7 +989,7 @@ void SyntacticalAnalyzer::else_part()
 		while (firsts.find(token) == firsts.end())
 			token = lex->GetToken();
 	}
-	if (token == NUMLIT_T || token == TRUE_T || token == FALSE_T || token == LPAREN_T || token == SQUOTE_T || token == IDENT_T || token == STRLIT_T)
+	if (token == NUMLIT_T || token == TRUE_T || token == FALSE_T || token == LPAREN_T || token == SQUOTE_T || token == IDENT_T || token == STRLIT_T || token == VECTOR_T)
 	{ // Rule 21
 		lex->debugFile << "Using Rule 21\n";
 		ruleFile << "Using Rule 21\n";
@@ -929,8 +1043,8 @@ void SyntacticalAnalyzer::else_part()
 void SyntacticalAnalyzer::stmt_pair()
 {
 	int errors = 0;
-	set<int> firsts{LPAREN_T, RPAREN_T, EOF_T};
-	set<int> follows{RPAREN_T, EOF_T};
+	static const set<int> firsts{LPAREN_T, RPAREN_T, EOF_T};
+	static const set<int> follows{RPAREN_T, EOF_T};
 
 	char message[100];
 	sprintf(message, "Entering Stmt_Pair function; current token is: %s, lexeme: %s", lex->GetTokenName(token).c_str(), lex->GetLexeme().c_str());
@@ -982,9 +1096,9 @@ void SyntacticalAnalyzer::stmt_pair()
 void SyntacticalAnalyzer::stmt_pair_body()
 {
 	int errors = 0;
-	set<int> firsts{NUMLIT_T, TRUE_T, FALSE_T, LPAREN_T, SQUOTE_T, IDENT_T,
-					STRLIT_T, ELSE_T, EOF_T};
-	set<int> follows{RPAREN_T, EOF_T};
+	static const set<int> firsts{NUMLIT_T, TRUE_T, FALSE_T, LPAREN_T, SQUOTE_T, IDENT_T,
+					STRLIT_T, VECTOR_T, ELSE_T, EOF_T};
+	static const set<int> follows{RPAREN_T, EOF_T};
 
 	char message[100];
 	sprintf(message, "Entering Stmt_Pair_Body function; current token is: %s, lexeme: %s", lex->GetTokenName(token).c_str(), lex->GetLexeme().c_str());
@@ -998,7 +1112,7 @@ void SyntacticalAnalyzer::stmt_pair_body()
 		while (firsts.find(token) == firsts.end())
 			token = lex->GetToken();
 	}
-	if (token == NUMLIT_T || token == TRUE_T || token == FALSE_T || token == LPAREN_T || token == SQUOTE_T || token == IDENT_T || token == STRLIT_T)
+	if (token == NUMLIT_T || token == TRUE_T || token == FALSE_T || token == LPAREN_T || token == SQUOTE_T || token == IDENT_T || token == STRLIT_T || token == VECTOR_T)
 	{ // Rule 25
 		lex->debugFile << "Using Rule 25\n";
 		ruleFile << "Using Rule 25\n";
@@ -1072,8 +1186,8 @@ void SyntacticalAnalyzer::stmt_pair_body()
 void SyntacticalAnalyzer::assign_pair()
 {
 	int errors = 0;
-	set<int> firsts{LPAREN_T, EOF_T};
-	set<int> follows{LPAREN_T, RPAREN_T, EOF_T};
+	static const set<int> firsts{LPAREN_T, EOF_T};
+	static const set<int> follows{LPAREN_T, RPAREN_T, EOF_T};
 
 	char message[100];
 	sprintf(message, "Entering Assign_Pair function; current token is: %s, lexeme: %s", lex->GetTokenName(token).c_str(), lex->GetLexeme().c_str());
@@ -1087,13 +1201,20 @@ void SyntacticalAnalyzer::assign_pair()
 		while (firsts.find(token) == firsts.end())
 			token = lex->GetToken();
 	}
+	// A let of the define's statements declares a variable for each name
+	// whose value is translated
+	Place where = place;
+	place = NESTED;
 	if (token == LPAREN_T)
 	{ // Rule 27
 		lex->debugFile << "Using Rule 27\n";
 		ruleFile << "Using Rule 27\n";
 		token = lex->GetToken();
+		int id = -1;
+		string name = lex->GetLexeme();
 		if (token == IDENT_T)
 		{
+			id = lex->GetSymbol();
 			token = lex->GetToken();
 		}
 		else
@@ -1102,7 +1223,17 @@ void SyntacticalAnalyzer::assign_pair()
 			sprintf(message, "'%s' expected ", token_lexemes[IDENT_T].c_str());
 			lex->ReportError(message);
 		}
-		stmt();
+		if (where == STATEMENT && id >= 0)
+		{
+			string init = operand(true);
+			if (!init.empty())
+			{
+				bound.push_back({id, variable(name, ++bindings)});
+				cg->WriteCode(indent, "Object " + bound.back().second + " = " + init + ";\n");
+			}
+		}
+		else
+			stmt();
 		if (token == RPAREN_T)
 		{
 			token = lex->GetToken();
@@ -1137,8 +1268,8 @@ void SyntacticalAnalyzer::assign_pair()
 void SyntacticalAnalyzer::more_assigns()
 {
 	int errors = 0;
-	set<int> firsts{LPAREN_T, RPAREN_T, EOF_T};
-	set<int> follows{RPAREN_T, EOF_T};
+	static const set<int> firsts{LPAREN_T, RPAREN_T, EOF_T};
+	static const set<int> follows{RPAREN_T, EOF_T};
 
 	char message[100];
 	sprintf(message, "Entering More_Assigns function; current token is: %s, lexeme: %s", lex->GetTokenName(token).c_str(), lex->GetLexeme().c_str());
@@ -1152,11 +1283,13 @@ void SyntacticalAnalyzer::more_assigns()
 		while (firsts.find(token) == firsts.end())
 			token = lex->GetToken();
 	}
+	Place where = place; // every pair of the let is read as the first is
 	if (token == LPAREN_T)
 	{ // Rule 28
 		lex->debugFile << "Using Rule 28\n";
 		ruleFile << "Using Rule 28\n";
 		assign_pair();
+		place = where;
 		more_assigns();
 	}
 	else if (token == RPAREN_T)
@@ -1207,17 +1340,25 @@ void SyntacticalAnalyzer::action()
 {
 	// cout << "Entering Action function, current token: " << lex->GetTokenName(token) << endl; // Debugging
 	int errors = 0;
-	set<int> firsts{IF_T, COND_T, LET_T, LISTOP1_T, LISTOP2_T, AND_T,
+	static const set<int> firsts{IF_T, COND_T, LET_T, LISTOP1_T, LISTOP2_T, AND_T,
 					OR_T, NOT_T, NUMBERP_T, LISTP_T, ZEROP_T, NULLP_T,
 					EOFP_T, PLUS_T, MINUS_T, DIV_T, MULT_T, MODULO_T,
 					ROUND_T, EQUALTO_T, GT_T, LT_T, GTE_T, LTE_T,
-					IDENT_T, DISPLAY_T, NEWLINE_T, READ_T, EOF_T};
-	set<int> follows{RPAREN_T, EOF_T};
+					IDENT_T, DISPLAY_T, NEWLINE_T, READ_T, MAKEHASH_T,
+					HASHREF_T, HASHSET_T, HASHCOUNT_T, MAKEVECTOR_T,
+					VECTORREF_T, VECTORSET_T, VECTORLENGTH_T, EOF_T};
+	static const set<int> follows{RPAREN_T, EOF_T};
 
 	char message[200];
 	sprintf(message, "Entering Action function; current token is: %s, lexeme: %s", lex->GetTokenName(token).c_str(), lex->GetLexeme().c_str());
 	lex->debugFile << message << endl;
 
+	// Only the form itself is a statement of the define or an operand
+	Place where = place;
+	place = NESTED;
+	if (where == NESTED && runtimeForms.find(token) != runtimeForms.end())
+		lex->ReportError("'" + lex->GetLexeme() + "' is only translated as a statement or an operand");
+
 	if (firsts.find(token) == firsts.end())
 	{
 		errors++;
@@ -1267,7 +1408,17 @@ void SyntacticalAnalyzer::action()
 			sprintf(message, "'%s' expected ", token_lexemes[LPAREN_T].c_str());
 			lex->ReportError(message);
 		}
+		// A let of the define's statements is a block, whose variables the
+		// names it binds stand for in its body, and only there
+		if (where == STATEMENT)
+			cg->WriteCode(indent++, "{\n");
+		size_t first = bound.size();
+		place = where;
 		more_assigns();
+		map<int, string> outer = locals;
+		for (size_t i = first; i < bound.size(); i++)
+			locals[bound[i].first] = bound[i].second;
+		bound.resize(first);
 		if (token == RPAREN_T)
 		{
 			token = lex->GetToken();
@@ -1278,8 +1429,13 @@ void SyntacticalAnalyzer::action()
 			sprintf(message, "'%s' expected ", token_lexemes[RPAREN_T].c_str());
 			lex->ReportError(message);
 		}
+		place = where;
 		stmt();
+		place = where;
 		stmt_list();
+		locals.swap(outer);
+		if (where == STATEMENT)
+			cg->WriteCode(--indent, "}\n");
 	}
 	else if (token == LISTOP1_T)
 	{ // Rule 33
@@ -1432,6 +1588,81 @@ void SyntacticalAnalyzer::action()
 		token = lex->GetToken();
 		stmt_list();
 	}
+	else if (token == MAKEHASH_T)
+	{ // Rule 94
+		lex->debugFile << "Using Rule 94\n";
+		ruleFile << "Using Rule 94\n";
+		token = lex->GetToken();
+		call(where, "make_hash_table", {});
+	}
+	else if (token == HASHREF_T)
+	{ // Rule 95
+		lex->debugFile << "Using Rule 95\n";
+		ruleFile << "Using Rule 95\n";
+		token = lex->GetToken();
+		string table = operand();
+		string key = operand();
+		call(where, "hash_ref", {table, key});
+	}
+	else if (token == HASHSET_T)
+	{ // Rule 96
+		lex->debugFile << "Using Rule 96\n";
+		ruleFile << "Using Rule 96\n";
+		token = lex->GetToken();
+		string table = operand();
+		string key = operand();
+		string item = operand();
+		call(where, "hash_set", {table, key, item});
+	}
+	else if (token == HASHCOUNT_T)
+	{ // Rule 97
+		lex->debugFile << "Using Rule 97\n";
+		ruleFile << "Using Rule 97\n";
+		token = lex->GetToken();
+		string table = operand();
+		call(where, "hash_count", {table});
+	}
+	else if (token == MAKEVECTOR_T)
+	{ // Rule 102
+		lex->debugFile << "Using Rule 102\n";
+		ruleFile << "Using Rule 102\n";
+		token = lex->GetToken();
+		// The length, and the fill if there is one
+		vector<string> args{operand()};
+		while (token != RPAREN_T && token != EOF_T)
+			args.push_back(operand());
+		if (args.size() > 2)
+			lex->ReportError("'make-vector' takes a length and an optional fill");
+		else
+			call(where, "make_vector", args);
+	}
+	else if (token == VECTORREF_T)
+	{ // Rule 103
+		lex->debugFile << "Using Rule 103\n";
+		ruleFile << "Using Rule 103\n";
+		token = lex->GetToken();
+		string vec = operand();
+		string index = operand();
+		call(where, "vector_ref", {vec, index});
+	}
+	else if (token == VECTORSET_T)
+	{ // Rule 104
+		lex->debugFile << "Using Rule 104\n";
+		ruleFile << "Using Rule 104\n";
+		token = lex->GetToken();
+		string vec = operand();
+		string index = operand();
+		string item = operand();
+		call(where, "vector_set", {vec, index, item});
+	}
+	else if (token == VECTORLENGTH_T)
+	{ // Rule 105
+		lex->debugFile << "Using Rule 105\n";
+		ruleFile << "Using Rule 105\n";
+		token = lex->GetToken();
+		string vec = operand();
+		call(where, "vector_length", {vec});
+	}
 	else if (token == IDENT_T)
 	{ // Rule 54
 		lex->debugFile << "Using Rule 54\n";
@@ -1454,55 +1685,55 @@ void SyntacticalAnalyzer::action()
 		{
 			token = lex->GetToken(); // Move to the opening parenthesis or the first element of the list
 
-			if (token == LPAREN_T) // Check if it's the start of a list
+			if (token == LPAREN_T || token == VECTOR_T)
 			{
-				string listRepresentation = "\"("; // Start of the list representation
-				bool firstElement = true;
-				token = lex->GetToken(); // Move to the first element of the list
-
-				while (token != RPAREN_T && token != EOF_T)
-				{
-					if (!firstElement)
-					{
-						listRepresentation += " ";
-					}
-					firstElement = false;
-
-					// Here, we append each element to the list representation
-					listRepresentation += lex->GetLexeme();
-					token = lex->GetToken(); // Move to the next element or the closing parenthesis
-				}
-
-				listRepresentation += ")\""; // End of the list representation
-				cg->WriteCode(1, "cout << Object(" + listRepresentation + ");\n");
-
-				if (token == RPAREN_T) // Check for the closing parenthesis of the list
-				{
-					token = lex->GetToken(); // Move past the closing parenthesis
-				}
+				// A quoted list or vector is a constant of the generated program
+				cg->WriteCode(indent, "display (" + cg->Literal(quotedLiteral()) + ");\n");
 			}
 			else
 			{
-				// Handling for non-list quoted literals (like 'a or '5)
-				string literalValue = "'" + lex->GetLexeme();
-				cg->WriteCode(1, "cout << Object(" + literalValue + ");\n");
+				// Handling for non-list quoted literals (like 'a or '5); a quoted
+				// name is output from the table of interned symbols
+				if (token == STRLIT_T)
+					cg->WriteCode(indent, "display (" + lex->GetLexeme() + ");\n");
+				else if (token == NUMLIT_T || token == TRUE_T || token == FALSE_T)
+					cg->WriteCode(indent, "display (" + cg->Literal(lex->GetLexeme()) + ");\n");
+				else
+				{
+					int id = token == IDENT_T ? lex->GetSymbol() : lex->Intern(lex->GetLexeme());
+					cg->WriteCode(indent, "display (symbols[" + to_string(id) + "]);\n");
+				}
 				token = lex->GetToken(); // Advance to the next token after the literal
 			}
 		}
 		else if (token == NUMLIT_T || token == STRLIT_T)
 		{
-			// Handling for unquoted literals
-			string arg = lex->GetLexeme();
-			cg->WriteCode(1, "cout << " + arg + ";\n");
+			// Handling for unquoted literals; numbers are constants, so that
+			// rationals and integers of any size keep their value
+			string arg = token == NUMLIT_T ? cg->Literal(lex->GetLexeme()) : lex->GetLexeme();
+			cg->WriteCode(indent, "display (" + arg + ");\n");
 			token = lex->GetToken();
 		}
+		else if (token == VECTOR_T)
+		{
+			// Handling for vector literals, which are self-quoting constants
+			cg->WriteCode(indent, "display (" + cg->Literal(quotedLiteral()) + ");\n");
+		}
+		else if (token == LPAREN_T || (token == IDENT_T && locals.count(lex->GetSymbol())))
+		{
+			// Handling for forms the runtime computes, such as (hash-count t),
+			// and for names a let has bound
+			string arg = operand();
+			if (!arg.empty())
+				cg->WriteCode(indent, "display (" + arg + ");\n");
+		}
 		//Here, we will handle other scenarios:
 	}
 	else if (token == NEWLINE_T)
 	{
 		lex->debugFile << "Using Rule for 'newline'\n";
 		ruleFile << "Using Rule for 'newline'\n";
-		cg->WriteCode(1, "cout << endl;\n");
+		cg->WriteCode(indent, "newline ();\n");
 		token = lex->GetToken(); // Advancing to the next token right here: 
 	}
 	else if (token == READ_T)
@@ -1547,7 +1778,8 @@ void SyntacticalAnalyzer::action()
  * --------------------------------------------------
  * Returns: void
  * --------------------------------------------------
- * Note: Implements a variety of rules (Rule 58 to 93)
+ * Note: Implements a variety of rules (Rule 58 to 93,
+ *       Rule 98 to 101 and Rule 107 to 111)
  *       to handle different token types. Ensures 
  *       proper handling of syntax and structure 
  *       in a PL460 program.
@@ -1556,20 +1788,24 @@ void SyntacticalAnalyzer::action()
 void SyntacticalAnalyzer::any_other_token()
 {
 	int errors = 0;
-	set<int> firsts{LPAREN_T, IDENT_T, NUMLIT_T, STRLIT_T, IF_T, DISPLAY_T,
+	static const set<int> firsts{LPAREN_T, IDENT_T, NUMLIT_T, STRLIT_T, IF_T, DISPLAY_T,
 					NEWLINE_T, READ_T, LISTOP1_T, LISTOP2_T, AND_T, OR_T,
 					NOT_T, DEFINE_T, LET_T, NUMBERP_T, LISTP_T, ZEROP_T,
 					NULLP_T, EOFP_T, PLUS_T, MINUS_T, DIV_T, MULT_T,
 					MODULO_T, ROUND_T, EQUALTO_T, GT_T, LT_T, GTE_T,
 					LTE_T, SQUOTE_T, COND_T, ELSE_T, TRUE_T, FALSE_T,
-					EOF_T};
-	set<int> follows{NUMLIT_T, LISTOP1_T, PLUS_T, MINUS_T, GT_T, LT_T,
+					MAKEHASH_T, HASHREF_T, HASHSET_T, HASHCOUNT_T,
+					MAKEVECTOR_T, VECTORREF_T, VECTORSET_T, VECTORLENGTH_T,
+					VECTOR_T, EOF_T};
+	static const set<int> follows{NUMLIT_T, LISTOP1_T, PLUS_T, MINUS_T, GT_T, LT_T,
 					 TRUE_T, FALSE_T, DIV_T, MULT_T, EQUALTO_T, GTE_T,
 					 LTE_T, LPAREN_T, RPAREN_T, SQUOTE_T, IDENT_T, IF_T,
 					 COND_T, DISPLAY_T, NEWLINE_T, AND_T, OR_T, NOT_T,
 					 DEFINE_T, LET_T, LISTOP2_T, NUMBERP_T, LISTP_T, ZEROP_T,
 					 NULLP_T, EOFP_T, MODULO_T, ROUND_T, READ_T, ELSE_T,
-					 STRLIT_T, EOF_T};
+					 MAKEHASH_T, HASHREF_T, HASHSET_T, HASHCOUNT_T,
+					 MAKEVECTOR_T, VECTORREF_T, VECTORSET_T, VECTORLENGTH_T,
+					 VECTOR_T, STRLIT_T, EOF_T};
 
 	char message[100];
 	sprintf(message, "Entering Any_Other_Token function; current token is: %s, lexeme: %s", lex->GetTokenName(token).c_str(), lex->GetLexeme().c_str());
@@ -1811,6 +2047,71 @@ void SyntacticalAnalyzer::any_other_token()
 		ruleFile << "Using Rule 93\n";
 		token = lex->GetToken();
 	}
+	else if (token == MAKEHASH_T)
+	{ // Rule 98
+		lex->debugFile << "Using Rule 98\n";
+		ruleFile << "Using Rule 98\n";
+		token = lex->GetToken();
+	}
+	else if (token == HASHREF_T)
+	{ // Rule 99
+		lex->debugFile << "Using Rule 99\n";
+		ruleFile << "Using Rule 99\n";
+		token = lex->GetToken();
+	}
+	else if (token == HASHSET_T)
+	{ // Rule 100
+		lex->debugFile << "Using Rule 100\n";
+		ruleFile << "Using Rule 100\n";
+		token = lex->GetToken();
+	}
+	else if (token == HASHCOUNT_T)
+	{ // Rule 101
+		lex->debugFile << "Using Rule 101\n";
+		ruleFile << "Using Rule 101\n";
+		token = lex->GetToken();
+	}
+	else if (token == MAKEVECTOR_T)
+	{ // Rule 107
+		lex->debugFile << "Using Rule 107\n";
+		ruleFile << "Using Rule 107\n";
+		token = lex->GetToken();
+	}
+	else if (token == VECTORREF_T)
+	{ // Rule 108
+		lex->debugFile << "Using Rule 108\n";
+		ruleFile << "Using Rule 108\n";
+		token = lex->GetToken();
+	}
+	else if (token == VECTORSET_T)
+	{ // Rule 109
+		lex->debugFile << "Using Rule 109\n";
+		ruleFile << "Using Rule 109\n";
+		token = lex->GetToken();
+	}
+	else if (token == VECTORLENGTH_T)
+	{ // Rule 110
+		lex->debugFile << "Using Rule 110\n";
+		ruleFile << "Using Rule 110\n";
+		token = lex->GetToken();
+	}
+	else if (token == VECTOR_T)
+	{ // Rule 111
+		lex->debugFile << "Using Rule 111\n";
+		ruleFile << "Using Rule 111\n";
+		token = lex->GetToken();
+		more_tokens();
+		if (token == RPAREN_T)
+		{
+			token = lex->GetToken();
+		}
+		else
+		{
+			errors++;
+			sprintf(message, "'%s' expected ", token_lexemes[RPAREN_T].c_str());
+			lex->ReportError(message);
+		}
+	}
 	else
 	{
 		errors++;
@@ -1829,3 +2130,165 @@ void SyntacticalAnalyzer::any_other_token()
 	sprintf(message, "Exiting Any_Other_Token function; current token is: %s", lex->GetTokenName(token).c_str());
 	return;
 }
+
+/****************************************************
+ * Function: SyntacticalAnalyzer::quotedLiteral
+ * --------------------------------------------------
+ * Purpose: Reads a list or vector literal, from its
+ *          '(' or '#(' through the matching ')',
+ *          and returns its text, from which the
+ *          runtime builds the constant once.
+ * --------------------------------------------------
+ * Parameters: None
+ * --------------------------------------------------
+ * Returns: string
+ ****************************************************/
+
+string SyntacticalAnalyzer::quotedLiteral()
+{
+	string text = lex->GetLexeme();
+	int depth = 1;
+	token = lex->GetToken(); // Move to the first element of the literal
+	while (token != EOF_T)
+	{
+		if (token == RPAREN_T && --depth == 0)
+			break;
+		if (token == LPAREN_T || token == VECTOR_T)
+			depth++;
+		if (text.back() != '(' && token != RPAREN_T)
+			text += " ";
+		text += lex->GetLexeme();
+		token = lex->GetToken();
+	}
+	text += ")";
+	if (token == RPAREN_T)
+		token = lex->GetToken(); // Move past the closing parenthesis
+	return text;
+}
+
+/****************************************************
+ * Function: SyntacticalAnalyzer::operand
+ * --------------------------------------------------
+ * Purpose: Reads one operand of a form that the
+ *          runtime implements and returns the C++
+ *          expression for its value: a constant for
+ *          a literal, a call for a nested form that
+ *          is translated, or the variable of a name
+ *          an enclosing let has bound. Any other
+ *          operand, such as a parameter, which is
+ *          not translated, is reported as such, and
+ *          an empty string is returned.
+ * --------------------------------------------------
+ * Parameters:
+ *    - quiet: Read an operand that is not translated
+ *             without reporting it.
+ * --------------------------------------------------
+ * Returns: string
+ ****************************************************/
+
+string SyntacticalAnalyzer::operand(bool quiet)
+{
+	string text;
+
+	if (token == SQUOTE_T)
+	{
+		token = lex->GetToken(); // Move to the quoted datum
+		if (token == LPAREN_T || token == VECTOR_T)
+			return cg->Literal(quotedLiteral());
+		if (token == RPAREN_T || token == EOF_T)
+		{
+			lex->ReportError("'" + lex->GetLexeme() + "' unexpected");
+			return text;
+		}
+		if (token == NUMLIT_T || token == STRLIT_T || token == TRUE_T || token == FALSE_T)
+			text = cg->Literal(lex->GetLexeme());
+		else
+		{
+			int id = token == IDENT_T ? lex->GetSymbol() : lex->Intern(lex->GetLexeme());
+			text = "symbols[" + to_string(id) + "]";
+		}
+		token = lex->GetToken();
+	}
+	else if (token == NUMLIT_T || token == STRLIT_T || token == TRUE_T || token == FALSE_T)
+	{
+		text = cg->Literal(lex->GetLexeme());
+		token = lex->GetToken();
+	}
+	else if (token == VECTOR_T)
+		text = cg->Literal(quotedLiteral());
+	else if (token == LPAREN_T)
+	{
+		lex->debugFile << "Using Rule 9\n";
+		ruleFile << "Using Rule 9\n";
+		token = lex->GetToken();
+		bool translated = runtimeForms.find(token) != runtimeForms.end();
+		if (!translated && !quiet)
+			lex->ReportError("'" + lex->GetLexeme() + "' is not translated as an operand");
+		place = translated || !quiet ? OPERAND : NESTED;
+		value.clear();
+		action();
+		text = value;
+		if (token == RPAREN_T)
+			token = lex->GetToken();
+		else
+			lex->ReportError("')' expected");
+	}
+	else if (token == IDENT_T && locals.count(lex->GetSymbol()))
+	{
+		text = locals[lex->GetSymbol()];
+		token = lex->GetToken();
+	}
+	else if (token == RPAREN_T || token == EOF_T)
+		lex->ReportError("'" + lex->GetLexeme() + "' unexpected");
+	else
+	{
+		if (!quiet)
+			lex->ReportError("'" + lex->GetLexeme() + "' is not translated as an operand");
+		stmt();
+	}
+	return text;
+}
+
+/****************************************************
+ * Function: SyntacticalAnalyzer::call
+ * --------------------------------------------------
+ * Purpose: Translates a form that the runtime
+ *          implements to a call of function with the
+ *          expressions args: a statement when the form
+ *          is one of the define, or the value of an
+ *          operand. A form used anywhere else, which
+ *          action reports, or with an operand that was
+ *          not translated is not written.
+ * --------------------------------------------------
+ * Parameters:
+ *    - where: STATEMENT, OPERAND or NESTED.
+ *    - function: The runtime function called.
+ *    - args: The C++ expressions of the operands.
+ * --------------------------------------------------
+ * Returns: void
+ ****************************************************/
+
+void SyntacticalAnalyzer::call(Place where, const string & function, const vector<string> & args)
+{
+	if (where == NESTED)
+		return;
+	string code = function + " (";
+	for (size_t i = 0; i < args.size(); i++)
+	{
+		if (args[i].empty())
+			return; // the operand has been reported
+		code += (i ? ", " : "") + args[i];
+	}
+	code += ")";
+	// Tables and vectors are the only cells the generated code makes; one
+	// stored in a table or vector that is not made by the same form, such as
+	// one a let has bound, may outlive it
+	if (function.compare(0, 5, "make_") == 0)
+		allocates = true;
+	else if ((function == "hash_set" || function == "vector_set") && args[0].compare(0, 5, "make_") != 0)
+		escapes = true;
+	if (where == STATEMENT)
+		cg->WriteCode(indent, code + ";\n");
+	else
+		value = code;
+}
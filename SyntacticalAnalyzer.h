@@ -12,6 +12,8 @@
 
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <vector>
 #include "LexicalAnalyzer.h"
 #include "CodeGenerator.h" // added for Project 3
 
@@ -29,13 +31,22 @@ using namespace std;
 class SyntacticalAnalyzer 
 {
     public:
-	SyntacticalAnalyzer (const string & fileNamePrefix);
+	SyntacticalAnalyzer (const string & fileNamePrefix, ostream & messages = cout);
+	SyntacticalAnalyzer (istream & input, int output, ostream & messages);
 	~SyntacticalAnalyzer ();
     private:
 	LexicalAnalyzer * lex;
 	CodeGenerator * cg; 
-	ofstream ruleFile;
+	OutputFile ruleFile;
 	token_type token;
+	bool allocates;	// the define being translated makes cells
+	bool escapes;	// the define being translated may store an Object outside its activation
+	enum Place { NESTED, STATEMENT, OPERAND } place;	// how the value of the next form is used
+	string value;	// the C++ expression for the last form read as an operand
+	map<int, string> locals;	// the C++ variable of each let-bound name in scope, by symbol
+	vector<pair<int, string>> bound;	// the names bound by the let being read, and their variables
+	int bindings;	// the let bindings translated in the define, which number their variables
+	int indent;		// the tab depth of the statements written
 
 	void program ();
 	void more_defines ();
@@ -56,6 +67,9 @@ class SyntacticalAnalyzer
 	void any_other_token ();
 	void handleNumberDisplay();
     void handleArithmeticOperation();
+	string quotedLiteral();
+	string operand(bool quiet = false);
+	void call(Place where, const string & function, const vector<string> & args);
 };
 
 #endif
@@ -0,0 +1,304 @@
+/*******************************************************************************
+* Title: Object runtime microbenchmark                                         *
+* Author: Seth Nuzum                                                           *
+* Date: 11-17-23                                                               *
+* File: OperatorBench.cpp                                                      *
+*                                                                              *
+* Description: This program times the Object runtime: each operator on each   *
+*              pair of operand types it is defined for, the unary operators    *
+*              and round, rational arithmetic, the list operations, building   *
+*              and walking lists, and output formatting. For each case it      *
+*              prints the mean time per operation in nanoseconds and the       *
+*              allocations per operation, both heap cells and operator new.    *
+*              Run it with "make opbench".                                     *
+*                                                                              *
+*              OperatorBench [count] [--json]      times every case            *
+*              OperatorBench --compare OLD NEW     compares two --json runs    *
+*******************************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <new>
+#include "Object.h"
+
+using namespace std;
+
+/********************************************************************************/
+/* Every allocation through operator new is counted; heap cells are counted by */
+/* the runtime.                                                                 */
+/********************************************************************************/
+static unsigned long long allocations;
+
+void * operator new (size_t size)
+{
+	allocations++;
+	if (void * p = malloc (size ? size : 1))
+		return p;
+	throw bad_alloc ();
+}
+
+void operator delete (void * p) noexcept
+{
+	free (p);
+}
+
+void operator delete (void * p, size_t) noexcept
+{
+	free (p);
+}
+
+static unsigned long long Allocations ()
+{
+	return allocations + gc_allocated ();
+}
+
+/********************************************************************************/
+/* Output is formatted onto a stream that discards it.                          */
+/********************************************************************************/
+struct Discard : streambuf
+{
+	int overflow (int c) override { return c; }
+	streamsize xsputn (const char *, streamsize n) override { return n; }
+};
+
+static bool json = false;
+static const char * separator = "";
+
+/********************************************************************************/
+/* This function times count calls of op and prints the mean time and the mean */
+/* number of allocations of one call.                                           */
+/********************************************************************************/
+template <class F> static void Run (const string & group, const string & name, long count, F op)
+{
+	for (long i = 0; i < count / 100; i++)	// warm up
+		op ();
+	unsigned long long before = Allocations ();
+	chrono::steady_clock::time_point start = chrono::steady_clock::now ();
+	for (long i = 0; i < count; i++)
+		op ();
+	chrono::duration <double, nano> elapsed = chrono::steady_clock::now () - start;
+	double ns = elapsed.count () / count;
+	double allocs = double (Allocations () - before) / count;
+	if (json)
+		printf ("%s\n  {\"group\": \"%s\", \"case\": \"%s\", \"ns_per_op\": %.2f, \"allocs_per_op\": %.3f}",
+			separator, group.c_str (), name.c_str (), ns, allocs);
+	else
+		printf ("%-10s %-28s %10.1f %10.2f\n", group.c_str (), name.c_str (), ns, allocs);
+	separator = ",";
+	fflush (stdout);
+}
+
+// Keeps the compiler from discarding a result
+template <class T> static inline void Use (T & value)
+{
+	asm volatile ("" : : "r" (&value) : "memory");
+}
+
+/********************************************************************************/
+/* The binary operators, on every pair of operand types they are defined for.  */
+/********************************************************************************/
+static const char * ops [] = {"+", "-", "*", "/", "%", "==", "!=", "<", "<=", ">", ">="};
+static const int OPS = 11;
+
+static void Operators (long count)
+{
+	struct { const char * name; Object value; } types [] = {
+		{"integer", Object (12345)},
+		{"real", Object (2.5)},
+		{"rational", Object (rational (7, 3))},
+		{"bigint", Object (string ("1180591620717411303424"))},
+		{"string", Object (string ("\"abc\""))},
+		{"list", Object (string ("(1 2 3)"))}};
+	for (auto & L : types)
+		for (auto & R : types)
+		{
+			bool numbers = numberp (L.value) && numberp (R.value);
+			bool strings = stringp (L.value) && stringp (R.value);
+			bool lists = listp (L.value) && listp (R.value);
+			bool integers = numbers && L.value.getType () == "integer" && R.value.getType () == "integer";
+			if (!numbers && !strings && !lists)
+				continue;
+			for (int op = 0; op < OPS; op++)
+			{
+				bool defined = numbers ? op != 4 || integers : strings ? op == 0 || op >= 5 : op == 0 || op == 5 || op == 6;
+				if (!defined)
+					continue;
+				const Object & A = L.value, & B = R.value;
+				string name = string (L.name) + " " + ops[op] + " " + R.name;
+				long n = op == 0 && (lists || strings) ? count / 20 : count;
+				Object result;
+				boolean test;
+				switch (op)
+				{
+					case 0: Run ("operator", name, n, [&] { result = A + B; Use (result); }); break;
+					case 1: Run ("operator", name, n, [&] { result = A - B; Use (result); }); break;
+					case 2: Run ("operator", name, n, [&] { result = A * B; Use (result); }); break;
+					case 3: Run ("operator", name, n, [&] { result = A / B; Use (result); }); break;
+					case 4: Run ("operator", name, n, [&] { result = A % B; Use (result); }); break;
+					case 5: Run ("operator", name, n, [&] { test = A == B; Use (test); }); break;
+					case 6: Run ("operator", name, n, [&] { test = A != B; Use (test); }); break;
+					case 7: Run ("operator", name, n, [&] { test = A < B; Use (test); }); break;
+					case 8: Run ("operator", name, n, [&] { test = A <= B; Use (test); }); break;
+					case 9: Run ("operator", name, n, [&] { test = A > B; Use (test); }); break;
+					case 10: Run ("operator", name, n, [&] { test = A >= B; Use (test); }); break;
+				}
+			}
+		}
+	struct { const char * name; Object value; } numbers [] = {
+		{"integer", Object (-12345)},
+		{"real", Object (2.5)},
+		{"rational", Object (rational (7, 3))},
+		{"bigint", Object (string ("1180591620717411303424"))}};
+	for (auto & N : numbers)
+	{
+		Object result;
+		boolean test;
+		Run ("unary", string ("! ") + N.name, count, [&] { test = !N.value; Use (test); });
+		Run ("unary", string ("round ") + N.name, count, [&] { result = round (N.value); Use (result); });
+	}
+}
+
+/********************************************************************************/
+/* The rational class on its own, without Object dispatch.                     */
+/********************************************************************************/
+static void Rationals (long count)
+{
+	rational A (7, 3), B (-5, 12), R;
+	Run ("rational", "7/3 + -5/12", count, [&] { R = A + B; Use (R); });
+	Run ("rational", "7/3 - -5/12", count, [&] { R = A - B; Use (R); });
+	Run ("rational", "7/3 * -5/12", count, [&] { R = A * B; Use (R); });
+	Run ("rational", "7/3 / -5/12", count, [&] { R = A / B; Use (R); });
+	Run ("rational", "7/3 < -5/12", count, [&] { bool test = A < B; Use (test); });
+	Run ("rational", "reduce 60/48", count, [&] { R = rational (bigint (60LL), bigint (48LL)); Use (R); });
+}
+
+/********************************************************************************/
+/* The list operations on a short list, and building and walking a list of     */
+/* 100 elements.                                                                */
+/********************************************************************************/
+static void Lists (long count)
+{
+	Object L = Object (string ("(1 (2 3) 4 5)")), empty = Object (string ("()")), X = Object (7), result;
+	Run ("listop", "car", count, [&] { result = car (L); Use (result); });
+	Run ("listop", "cdr", count, [&] { result = cdr (L); Use (result); });
+	Run ("listop", "cadr", count, [&] { result = cxr ("cadr", L); Use (result); });
+	Run ("listop", "listop caadr", count, [&] { result = listop ("caadr", L); Use (result); });
+	Run ("listop", "cons", count, [&] { result = cons (X, L); Use (result); });
+	Run ("listop", "list", count, [&] { result = listof (X); Use (result); });
+	Run ("listop", "append (4 elements)", count / 4, [&] { result = append (L, L); Use (result); });
+	Run ("list", "build 100 by cons", count / 100, [&]
+	{
+		Object built = empty;
+		for (int i = 0; i < 100; i++)
+			built = cons (X, built);
+		Use (built);
+	});
+	Object hundred = empty;
+	for (int i = 0; i < 100; i++)
+		hundred = cons (Object (i), hundred);
+	Run ("list", "walk 100 by cdr", count / 100, [&]
+	{
+		Object P = hundred;
+		while (!nullp (P))
+			P = cdr (P);
+		Use (P);
+	});
+}
+
+/********************************************************************************/
+/* Formatting with operator <<; the output is discarded.                        */
+/********************************************************************************/
+static void Formatting (long count)
+{
+	Discard sink;
+	ostream out (&sink);
+	Object hash = make_hash_table ();
+	for (int i = 0; i < 10; i++)
+		hash_set (hash, Object (i), Object (i * i));
+	struct { const char * name; Object value; } values [] = {
+		{"integer", Object (-1234567)},
+		{"real", Object (3.14159)},
+		{"rational", Object (rational (22, 7))},
+		{"bigint", Object (string ("1180591620717411303424"))},
+		{"string", Object (string ("\"a string\""))},
+		{"symbol", symbol ("name")},
+		{"list of 10", Object (string ("(1 2 3 4 5 6 7 8 9 10)"))},
+		{"nested list", Object (string ("(1 (2 (3 (4 (5)))) \"s\" 2.5)"))},
+		{"vector of 10", Object (string ("#(1 2 3 4 5 6 7 8 9 10)"))},
+		{"hash of 10", hash}};
+	for (auto & V : values)
+		Run ("format", V.name, count / 10, [&] { out << V.value; });
+}
+
+/********************************************************************************/
+/* This function prints the cases of two --json runs side by side, with the    */
+/* ratio of the new time to the old.                                            */
+/********************************************************************************/
+static map <string, pair <double, double>> ReadRun (const char * file)
+{
+	map <string, pair <double, double>> cases;
+	ifstream in (file);
+	if (!in)
+	{
+		fprintf (stderr, "%s not found\n", file);
+		exit (1);
+	}
+	string line;
+	while (getline (in, line))
+	{
+		size_t group = line.find ("\"group\": \""), name = line.find ("\"case\": \""),
+			ns = line.find ("\"ns_per_op\": "), allocs = line.find ("\"allocs_per_op\": ");
+		if (group == string::npos || name == string::npos || ns == string::npos || allocs == string::npos)
+			continue;
+		group += 10;
+		name += 9;
+		string key = line.substr (group, line.find ('"', group) - group) + " " +
+			line.substr (name, line.find ('"', name) - name);
+		cases[key] = make_pair (atof (line.c_str () + ns + 13), atof (line.c_str () + allocs + 17));
+	}
+	return cases;
+}
+
+static void Compare (const char * oldFile, const char * newFile)
+{
+	map <string, pair <double, double>> before = ReadRun (oldFile), after = ReadRun (newFile);
+	printf ("%-39s %10s %10s %7s %10s %10s\n", "case", "old ns", "new ns", "ratio", "old alloc", "new alloc");
+	for (auto & C : after)
+	{
+		auto B = before.find (C.first);
+		if (B == before.end ())
+			continue;
+		printf ("%-39s %10.1f %10.1f %7.2f %10.2f %10.2f\n", C.first.c_str (), B->second.first, C.second.first,
+			B->second.first > 0 ? C.second.first / B->second.first : 0.0, B->second.second, C.second.second);
+	}
+}
+
+int main (int argc, char * argv [])
+{
+	long count = 1000000;
+	for (int i = 1; i < argc; i++)
+		if (strcmp (argv[i], "--json") == 0)
+			json = true;
+		else if (strcmp (argv[i], "--compare") == 0 && i + 2 < argc)
+		{
+			Compare (argv[i + 1], argv[i + 2]);
+			return 0;
+		}
+		else
+			count = atol (argv[i]);
+	if (json)
+		printf ("[");
+	else
+		printf ("%-10s %-28s %10s %10s\n", "group", "case", "ns/op", "allocs/op");
+	Operators (count);
+	Rationals (count);
+	Lists (count);
+	Formatting (count);
+	if (json)
+		printf ("\n]\n");
+	return 0;
+}
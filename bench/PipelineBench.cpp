@@ -0,0 +1,212 @@
+/*******************************************************************************
+* Title: Translate, compile and run latency benchmark                          *
+* Author: Seth Nuzum                                                           *
+* Date: 11-17-23                                                               *
+* File: PipelineBench.cpp                                                      *
+*                                                                              *
+* Description: This program times the chain run1 runs for each program of a   *
+*              corpus: translating it with P3.out, compiling the generated     *
+*              C++, linking it with Object.o and running it. Each program is   *
+*              put through the chain repeatedly, and the minimum, percentiles  *
+*              and maximum of each stage and of the whole chain are printed    *
+*              in milliseconds. Run it with "make pipeline".                   *
+*                                                                              *
+*              PipelineBench [--runs N] [--cxxflags FLAGS] [--json] [FILE...]  *
+*              The corpus is the .pl460 files named, or by default             *
+*              P3Test1.pl460 and two programs built from the statements in     *
+*              bench/Statements.pl460.                                         *
+*******************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+static const char * stages [] = {"translate", "compile", "link", "execute", "total"};
+static const int STAGES = 5;
+static const char * CORPUS = "bench/corpus/pipeline";
+static const int LONG_REPEATS = 100;	// copies of the statements in the long program
+
+/********************************************************************************/
+/* This function runs a command with its output discarded and returns its wall */
+/* time in seconds, or a negative time if it could not be run or failed.        */
+/********************************************************************************/
+static double Run (const vector <string> & command)
+{
+	vector <char *> argv;
+	for (const string & arg : command)
+		argv.push_back (const_cast <char *> (arg.c_str ()));
+	argv.push_back (NULL);
+	chrono::steady_clock::time_point start = chrono::steady_clock::now ();
+	pid_t child = fork ();
+	if (child == 0)
+	{
+		int null = open ("/dev/null", O_RDWR);
+		dup2 (null, 0);
+		dup2 (null, 1);
+		execvp (argv[0], argv.data ());
+		_exit (127);
+	}
+	int status = 0;
+	if (child < 0 || waitpid (child, &status, 0) < 0)
+		return -1;
+	double seconds = chrono::duration <double> (chrono::steady_clock::now () - start).count ();
+	return WIFEXITED (status) && WEXITSTATUS (status) == 0 ? seconds : -1;
+}
+
+/********************************************************************************/
+/* This function returns the value below which fraction p of the sorted times  */
+/* fall (the nearest rank).                                                     */
+/********************************************************************************/
+static double Percentile (const vector <double> & sorted, double p)
+{
+	size_t rank = size_t (p * sorted.size () + 0.999999);
+	return sorted[min (sorted.size (), max (rank, size_t (1))) - 1];
+}
+
+/********************************************************************************/
+/* This function copies a program into the corpus directory, where its outputs */
+/* are written, and returns its prefix there.                                   */
+/********************************************************************************/
+static string Stage (const string & file)
+{
+	string name = file.substr (file.rfind ('/') + 1);
+	string prefix = string (CORPUS) + "/" + name.substr (0, name.size () - 6);
+	if (file != prefix + ".pl460")
+	{
+		ifstream in (file);
+		ofstream out (prefix + ".pl460");
+		out << in.rdbuf ();
+	}
+	return prefix;
+}
+
+/********************************************************************************/
+/* The default corpus: P3Test1.pl460, and a main whose body is the statements  */
+/* of bench/Statements.pl460 once and LONG_REPEATS times.                       */
+/********************************************************************************/
+static void MakeMain (const string & file, const string & statements, int repeats)
+{
+	ofstream out (file);
+	out << "(define (main)\n";
+	for (int r = 0; r < repeats; r++)
+		out << statements;
+	out << ")\n\n(main)\n";
+}
+
+static vector <string> DefaultCorpus ()
+{
+	vector <string> files = {"P3Test1.pl460"};
+	ifstream in ("bench/Statements.pl460");
+	if (in)
+	{
+		stringstream statements;
+		statements << in.rdbuf ();
+		MakeMain (string (CORPUS) + "/Statements.pl460", statements.str (), 1);
+		MakeMain (string (CORPUS) + "/LongMain.pl460", statements.str (), LONG_REPEATS);
+		files.push_back (string (CORPUS) + "/Statements.pl460");
+		files.push_back (string (CORPUS) + "/LongMain.pl460");
+	}
+	return files;
+}
+
+int main (int argc, char * argv [])
+{
+	int runs = 10;
+	bool json = false;
+	string cxxflags;
+	vector <string> files;
+	for (int i = 1; i < argc; i++)
+		if (strcmp (argv[i], "--runs") == 0 && i + 1 < argc)
+			runs = max (1, atoi (argv[++i]));
+		else if (strcmp (argv[i], "--cxxflags") == 0 && i + 1 < argc)
+			cxxflags = argv[++i];
+		else if (strcmp (argv[i], "--json") == 0)
+			json = true;
+		else
+			files.push_back (argv[i]);
+	if (access ("P3.out", X_OK) != 0 || access ("Object.o", R_OK) != 0)
+	{
+		fprintf (stderr, "P3.out and Object.o not found; run \"make\" in the top directory\n");
+		exit (1);
+	}
+	mkdir ("bench/corpus", 0755);
+	mkdir (CORPUS, 0755);
+	if (files.empty ())
+		files = DefaultCorpus ();
+	vector <string> flags;
+	istringstream words (cxxflags);
+	for (string word; words >> word; )
+		flags.push_back (word);
+
+	if (json)
+		printf ("[");
+	else
+		printf ("%-14s %-10s %9s %9s %9s %9s %9s\n", "program", "stage", "min ms", "p50 ms", "p90 ms",
+			"p99 ms", "max ms");
+	const char * separator = "";
+	for (const string & file : files)
+	{
+		string prefix = Stage (file);
+		string name = prefix.substr (prefix.rfind ('/') + 1);
+		vector <string> translate = {"./P3.out", prefix + ".pl460"};
+		vector <string> compile = {"g++", "-I.", "-c", prefix + ".cpp", "-o", prefix + ".o"};
+		compile.insert (compile.begin () + 1, flags.begin (), flags.end ());
+		vector <string> link = {"g++", prefix + ".o", "Object.o", "-o", prefix};
+		vector <string> execute = {prefix};
+		vector <string> * commands [] = {&translate, &compile, &link, &execute};
+
+		vector <double> times [STAGES];
+		bool failed = false;
+		for (int r = 0; r <= runs && !failed; r++)	// run 0 warms up
+		{
+			double total = 0;
+			for (int s = 0; s < STAGES - 1 && !failed; s++)
+			{
+				double seconds = Run (*commands[s]);
+				if (seconds < 0)
+				{
+					fprintf (stderr, "%s: %s failed\n", file.c_str (), stages[s]);
+					failed = true;
+				}
+				else if (r)
+					times[s].push_back (seconds);
+				total += seconds;
+			}
+			if (r && !failed)
+				times[STAGES - 1].push_back (total);
+		}
+		if (failed)
+			continue;
+		for (int s = 0; s < STAGES; s++)
+		{
+			sort (times[s].begin (), times[s].end ());
+			double values [] = {times[s].front (), Percentile (times[s], 0.5), Percentile (times[s], 0.9),
+				Percentile (times[s], 0.99), times[s].back ()};
+			if (json)
+				printf ("%s\n  {\"program\": \"%s\", \"stage\": \"%s\", \"runs\": %d, \"min_ms\": %.3f, "
+					"\"p50_ms\": %.3f, \"p90_ms\": %.3f, \"p99_ms\": %.3f, \"max_ms\": %.3f}", separator,
+					name.c_str (), stages[s], runs, values[0] * 1e3, values[1] * 1e3, values[2] * 1e3,
+					values[3] * 1e3, values[4] * 1e3);
+			else
+				printf ("%-14s %-10s %9.1f %9.1f %9.1f %9.1f %9.1f\n", name.c_str (), stages[s],
+					values[0] * 1e3, values[1] * 1e3, values[2] * 1e3, values[3] * 1e3, values[4] * 1e3);
+			separator = ",";
+		}
+		fflush (stdout);
+	}
+	if (json)
+		printf ("\n]\n");
+	return 0;
+}
@@ -0,0 +1,516 @@
+/*******************************************************************************
+* Title: Synthetic PL460 program generator                                     *
+* Author: Seth Nuzum                                                           *
+* Date: 11-17-23                                                               *
+* File: ProgramGenerator.cpp                                                   *
+*                                                                              *
+* Description: This program writes a random PL460 program that follows the    *
+*              grammar the syntactical analyzer implements: a run of defines   *
+*              with parameter lists and statement bodies, ending with a call   *
+*              of main. Every program it writes translates without errors;     *
+*              "make gencheck" checks that for several seeds. The same seed    *
+*              and options always produce the same program, so a slow or       *
+*              failing input can be reproduced from its command line. Build    *
+*              it with "make generator".                                       *
+*                                                                              *
+*              ProgramGenerator [options] [-o FILE]                            *
+*                --seed N        seed of the random choices (1)                *
+*                --defines N     number of defines, main included (10)         *
+*                --size BYTES    add defines until the program is this long    *
+*                --depth N       deepest nesting of statements and lists (4)   *
+*                --width N       most elements of a list literal, and most     *
+*                                arguments of a call (5)                       *
+*                --statements N  most statements in a body (8)                 *
+*                --mix NAME=W,.. weight of each form; * sets every weight      *
+*                --forms         lists the forms and their default weights     *
+*******************************************************************************/
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/********************************************************************************/
+/* Each form a statement can take, with the rule of the grammar it exercises,   */
+/* the number of statements it takes (a minimum, and whether a list of any     */
+/* length follows), its default weight, and whether the translator writes it    */
+/* as a call of the runtime. Those are only translated as a statement of a      */
+/* define, or as an operand of display or of another of them, and their        */
+/* operands must be literals or more of them.                                   */
+/********************************************************************************/
+struct Form
+{
+	const char * name;
+	const char * rule;
+	int arguments;
+	bool list;
+	int weight;
+	bool runtime;
+};
+
+static Form forms [] = {
+	{"literal", "7, 10-13, 106", 0, false, 8, false},
+	{"ident", "8", 0, false, 4, false},
+	{"if", "30", 2, false, 2, false},
+	{"cond", "31", 0, false, 1, false},
+	{"let", "32", 0, false, 1, false},
+	{"car", "33", 1, false, 1, false},
+	{"cons", "34", 2, false, 1, false},
+	{"and", "35", 0, true, 1, false},
+	{"or", "36", 0, true, 1, false},
+	{"not", "37", 1, false, 1, false},
+	{"number?", "38", 1, false, 1, false},
+	{"list?", "39", 1, false, 1, false},
+	{"zero?", "40", 1, false, 1, false},
+	{"null?", "41", 1, false, 1, false},
+	{"eof?", "42", 1, false, 1, false},
+	{"+", "43", 0, true, 2, false},
+	{"-", "44", 1, true, 2, false},
+	{"/", "45", 1, true, 1, false},
+	{"*", "46", 0, true, 2, false},
+	{"modulo", "47", 2, false, 1, false},
+	{"round", "48", 1, false, 1, false},
+	{"=", "49", 0, true, 1, false},
+	{">", "50", 0, true, 1, false},
+	{"<", "51", 0, true, 1, false},
+	{">=", "52", 0, true, 1, false},
+	{"<=", "53", 0, true, 1, false},
+	{"call", "54", 0, true, 2, false},
+	{"display", "55", 1, false, 3, false},
+	{"newline", "56", 0, false, 2, false},
+	{"read", "57", 0, false, 1, false},
+	{"make-hash-table", "94", 0, false, 1, true},
+	{"hash-ref", "95", 2, false, 1, true},
+	{"hash-set!", "96", 3, false, 1, true},
+	{"hash-count", "97", 1, false, 1, true},
+	{"make-vector", "102", 1, false, 1, true},
+	{"vector-ref", "103", 2, false, 1, true},
+	{"vector-set!", "104", 3, false, 1, true},
+	{"vector-length", "105", 1, false, 1, true}};
+static const int FORMS = sizeof (forms) / sizeof (forms[0]);
+
+// Spellings of the list operators taking one and two statements
+static const char * listop1 [] = {"car", "cdr", "cadr", "cddr", "caadr", "list"};
+static const char * listop2 [] = {"cons", "append"};
+
+// Keywords, which may appear inside a quoted literal
+static const char * keywords [] = {"if", "cond", "let", "and", "or", "not", "define", "else",
+	"display", "newline", "read", "modulo", "round", "number?", "list?", "zero?", "null?",
+	"eof?", "car", "cons", "+", "-", "*", "/", "=", "<", ">", "<=", ">=", "make-hash-table",
+	"hash-ref", "hash-set!", "hash-count", "make-vector", "vector-ref", "vector-set!",
+	"vector-length"};
+
+struct Options
+{
+	unsigned long long seed = 1;
+	long defines = 10;
+	long size = 0;
+	int depth = 4;
+	int width = 5;
+	int statements = 8;
+};
+
+/********************************************************************************/
+/* The generator writes a program into a string. Every choice is drawn from one */
+/* engine whose output sequence the standard fixes, so a seed gives the same    */
+/* program on any platform.                                                     */
+/********************************************************************************/
+class Generator
+{
+    public:
+	Generator (const Options & options) : options (options), engine (options.seed)
+	{
+		for (int f = 0; f < FORMS; f++)
+		{
+			total += forms[f].weight;
+			ordinary += forms[f].runtime ? 0 : forms[f].weight;
+		}
+	}
+	string Define (long number, bool main);
+	string Main ();
+    private:
+	const Options & options;
+	mt19937_64 engine;
+	int total = 0;
+	int ordinary = 0;		// the weight of the forms not written as runtime calls
+	long defined = 0;		// defines written so far, which calls may name
+	vector <string> names;		// parameters and let variables in scope
+	int lets = 0;
+	string text;
+
+	unsigned long Below (unsigned long n) { return n ? engine () % n : 0; }
+	void Statement (int depth, bool runtime);
+	void Statements (int depth, int least, int most, bool list);
+	void Operand (int depth, bool display);
+	void Call (const Form & form, int depth);
+	void Literal (int depth, bool display);
+	void Quoted (int depth);
+	void Number ();
+	void String ();
+	void Name ();
+};
+
+void Generator::Number ()
+{
+	if (Below (4) == 0)
+		text += '-';
+	text += to_string (Below (100000));
+	if (Below (3) == 0)
+		text += "." + to_string (Below (1000));
+}
+
+void Generator::String ()
+{
+	static const char * words [] = {"alpha", "beta", "gamma", "a string", "x", "", "with  spaces"};
+	text += '"';
+	text += words[Below (sizeof (words) / sizeof (words[0]))];
+	text += '"';
+}
+
+void Generator::Name ()
+{
+	if (!names.empty () && Below (4) != 0)
+		text += names[Below (names.size ())];
+	else
+		text += "g" + to_string (Below (50));
+}
+
+/********************************************************************************/
+/* A quoted literal: any token but a closing parenthesis, or a list or vector  */
+/* of them (rules 58 to 93, 98 to 101 and 107 to 111).                          */
+/********************************************************************************/
+void Generator::Quoted (int depth)
+{
+	unsigned long kind = depth >= options.depth ? Below (5) : Below (7);
+	switch (kind)
+	{
+		case 0: Number (); break;
+		case 1: String (); break;
+		case 2: Name (); break;
+		case 3: text += keywords[Below (sizeof (keywords) / sizeof (keywords[0]))]; break;
+		case 4: text += Below (2) ? "#t" : "#f"; break;
+		default:
+		{
+			text += kind == 5 ? "(" : "#(";
+			int elements = Below (options.width + 1);
+			for (int e = 0; e < elements; e++)
+			{
+				if (e)
+					text += ' ';
+				if (Below (8) == 0)
+					text += '\'';
+				Quoted (depth + 1);
+			}
+			text += ')';
+		}
+	}
+}
+
+/********************************************************************************/
+/* A literal: a number, a string, a quoted literal, a boolean or a vector       */
+/* (rules 10 to 13 and 106). display takes no bare boolean, so one there is     */
+/* quoted.                                                                      */
+/********************************************************************************/
+void Generator::Literal (int depth, bool display)
+{
+	switch (Below (5))
+	{
+		case 0: Number (); break;
+		case 1: String (); break;
+		case 2: text += '\''; Quoted (depth); break;
+		case 3: text += display ? "'" : ""; text += Below (2) ? "#t" : "#f"; break;
+		case 4:
+		{
+			text += "#(";
+			int elements = Below (options.width + 1);
+			for (int e = 0; e < elements; e++)
+			{
+				if (e)
+					text += ' ';
+				Quoted (depth + 1);
+			}
+			text += ')';
+		}
+	}
+}
+
+/********************************************************************************/
+/* The statements of a form. The analyzer reads a statement together with the  */
+/* forms in parentheses right after it, so unless the form takes a list, the   */
+/* statements after the first are literals and names.                           */
+/********************************************************************************/
+void Generator::Statements (int depth, int least, int most, bool list)
+{
+	int count = least + Below (most - least + 1);
+	for (int s = 0; s < count; s++)
+	{
+		text += ' ';
+		Statement (s && !list ? options.depth : depth, false);
+	}
+}
+
+/********************************************************************************/
+/* An operand of a form written as a call of the runtime, or of display: a     */
+/* literal, or below the deepest nesting one of those forms.                    */
+/********************************************************************************/
+void Generator::Operand (int depth, bool display)
+{
+	int sum = forms[0].weight + (depth < options.depth ? total - ordinary : 0);
+	unsigned long pick = Below (sum);
+	if (sum == 0 || pick < unsigned (forms[0].weight))
+		return Literal (depth, display);
+	pick -= forms[0].weight;
+	const Form * form = forms;
+	for (; !form->runtime || pick >= unsigned (form->weight); form++)
+		if (form->runtime)
+			pick -= form->weight;
+	Call (*form, depth);
+}
+
+// A form written as a call of the runtime; make-vector may have a fill
+void Generator::Call (const Form & form, int depth)
+{
+	text += '(';
+	text += form.name;
+	int count = form.arguments + (string (form.name) == "make-vector" ? Below (2) : 0);
+	for (int a = 0; a < count; a++)
+	{
+		text += ' ';
+		Operand (depth + 1, false);
+	}
+	text += ')';
+}
+
+/********************************************************************************/
+/* A statement (rules 7 to 9): a literal or an identifier, or below the deepest */
+/* nesting, a form drawn by weight. Forms written as calls of the runtime are   */
+/* drawn only for a statement of a define (runtime).                            */
+/********************************************************************************/
+void Generator::Statement (int depth, bool runtime)
+{
+	const Form * form = &forms[0];
+	int sum = runtime ? total : ordinary;
+	if (depth < options.depth && sum > forms[0].weight + forms[1].weight)
+	{
+		unsigned long pick = Below (sum);
+		for (form = forms; (form->runtime && !runtime) || pick >= unsigned (form->weight); form++)
+			if (runtime || !form->runtime)
+				pick -= form->weight;
+	}
+	else if (forms[0].weight == 0 && forms[1].weight > 0)
+		form = &forms[1];
+	else if (forms[0].weight > 0 && forms[1].weight > 0 && Below (forms[0].weight + forms[1].weight) >= unsigned (forms[0].weight))
+		form = &forms[1];
+
+	string name = form->name;
+	if (name == "literal")
+		return Literal (depth, false);
+	if (name == "ident")
+		return Name ();
+	if (form->runtime)
+		return Call (*form, depth);
+
+	text += '(';
+	if (name == "cond")
+	{
+		text += "cond";
+		int pairs = Below (options.width) + 1;
+		for (int p = 0; p < pairs; p++)
+		{
+			text += " (";
+			Statements (depth + 1, 2, 2, false);
+			text += ')';
+		}
+		if (Below (2))
+		{
+			text += " (else ";
+			Statement (depth + 1, false);
+			text += ')';
+		}
+	}
+	else if (name == "let")
+	{
+		text += "let (";
+		int assigns = Below (options.width + 1);
+		vector <string> bound;
+		for (int a = 0; a < assigns; a++)
+		{
+			bound.push_back ("v" + to_string (lets++));
+			text += (a ? " (" : "(") + bound.back () + ' ';
+			Statement (depth + 1, false);
+			text += ')';
+		}
+		text += ')';
+		names.insert (names.end (), bound.begin (), bound.end ());
+		Statements (depth + 1, 1, options.width, true);
+		names.resize (names.size () - bound.size ());
+	}
+	else
+	{
+		if (name == "call")
+			text += "f" + to_string (Below (defined) + 1);
+		else if (name == "car")
+			text += listop1[Below (sizeof (listop1) / sizeof (listop1[0]))];
+		else if (name == "cons")
+			text += listop2[Below (sizeof (listop2) / sizeof (listop2[0]))];
+		else
+			text += name;
+		if (name == "if")
+			Statements (depth + 1, 2, 3, false);
+		else if (name == "display")
+		{
+			text += ' ';
+			Operand (depth + 1, true);
+		}
+		else
+			Statements (depth + 1, form->arguments, form->arguments + (form->list ? options.width : 0), form->list);
+	}
+	text += ')';
+}
+
+/********************************************************************************/
+/* A define (rule 4) of function number, or of main, with up to three          */
+/* parameters and a body of statements.                                         */
+/********************************************************************************/
+string Generator::Define (long number, bool main)
+{
+	text.clear ();
+	text += main ? "(define (main" : "(define (f" + to_string (number);
+	names.clear ();
+	int parameters = main ? 0 : Below (4);
+	for (int p = 0; p < parameters; p++)
+	{
+		names.push_back ("p" + to_string (p));
+		text += ' ' + names.back ();
+	}
+	text += ")\n";
+	int count = 1 + Below (options.statements);
+	for (int s = 0; s < count; s++)
+	{
+		text += '\t';
+		Statement (0, true);
+		text += '\n';
+	}
+	text += ")\n\n";
+	defined = number;
+	return text;
+}
+
+// The call of main that ends a program (rule 3)
+string Generator::Main ()
+{
+	return "(main)\n";
+}
+
+static void Usage ()
+{
+	cerr << "usage: ProgramGenerator [--seed N] [--defines N] [--size BYTES] [--depth N] [--width N]\n"
+		"                        [--statements N] [--mix NAME=WEIGHT,...] [--forms] [-o FILE]\n";
+	exit (1);
+}
+
+/********************************************************************************/
+/* This function sets the weights named in a --mix argument, for example        */
+/* "*=0,+=3,display=1"; * sets every weight.                                    */
+/********************************************************************************/
+static void Mix (const string & mix)
+{
+	size_t start = 0;
+	while (start < mix.size ())
+	{
+		size_t end = mix.find (',', start);
+		if (end == string::npos)
+			end = mix.size ();
+		string entry = mix.substr (start, end - start);
+		size_t equals = entry.rfind ('=');
+		if (equals == string::npos || equals == 0)
+		{
+			cerr << "--mix: '" << entry << "' is not NAME=WEIGHT\n";
+			exit (1);
+		}
+		string name = entry.substr (0, equals);
+		int weight = atoi (entry.c_str () + equals + 1);
+		bool found = false;
+		for (int f = 0; f < FORMS; f++)
+			if (name == "*" || name == forms[f].name)
+			{
+				forms[f].weight = weight < 0 ? 0 : weight;
+				found = true;
+			}
+		if (!found)
+		{
+			cerr << "--mix: no form named '" << name << "'; --forms lists them\n";
+			exit (1);
+		}
+		start = end + 1;
+	}
+}
+
+int main (int argc, char * argv [])
+{
+	Options options;
+	const char * file = NULL;
+	for (int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+		if (arg == "--forms")
+		{
+			for (int f = 0; f < FORMS; f++)
+				cout << forms[f].name << "\tweight " << forms[f].weight << "\trule " << forms[f].rule << endl;
+			return 0;
+		}
+		if (i + 1 >= argc)
+			Usage ();
+		const char * value = argv[++i];
+		if (arg == "--seed")
+			options.seed = strtoull (value, NULL, 10);
+		else if (arg == "--defines")
+			options.defines = atol (value);
+		else if (arg == "--size")
+			options.size = atol (value);
+		else if (arg == "--depth")
+			options.depth = atoi (value);
+		else if (arg == "--width")
+			options.width = atoi (value);
+		else if (arg == "--statements")
+			options.statements = atoi (value);
+		else if (arg == "--mix")
+			Mix (value);
+		else if (arg == "-o")
+			file = value;
+		else
+			Usage ();
+	}
+	if (options.defines < 1 || options.depth < 0 || options.width < 1 || options.statements < 1)
+		Usage ();
+
+	ofstream output;
+	if (file)
+	{
+		output.open (file);
+		if (!output)
+		{
+			cerr << file << " could not be opened\n";
+			exit (1);
+		}
+	}
+	ostream & out = file ? output : cout;
+
+	// With --size, defines are added until the program is long enough
+	Generator generator (options);
+	long written = 0, d = 1;
+	for (; options.size > 0 ? written < options.size : d < options.defines; d++)
+	{
+		string define = generator.Define (d, false);
+		out << define;
+		written += define.size ();
+	}
+	out << generator.Define (d, true);
+	out << generator.Main ();
+	return 0;
+}
@@ -0,0 +1,56 @@
+#!/bin/sh
+################################################################################
+# Title: Streaming translation memory test                                     #
+# Author: Seth Nuzum                                                           #
+# Date: 11-17-23                                                               #
+# File: StreamTest.sh                                                          #
+#                                                                              #
+# Description: This script pipes a generated program of MB megabytes, and one  #
+#              of an eighth of that, through "P3.out --stream" and checks that #
+#              every define was translated without errors and that the peak    #
+#              resident set size did not grow with the size of the input.     #
+#              Nothing is written to disk. Run it with "make stream".         #
+#                                                                              #
+#              bench/StreamTest.sh [MB]        MB is 2048 by default           #
+################################################################################
+
+MB=${1:-2048}
+FORM="(define (f) (display '(a b \"c\" 1.5)) (newline) (display 42) (display 'sym) (display #(1 2)))"
+BYTES=$(( ${#FORM} + 1 ))
+REPORT=$(mktemp)
+trap 'rm -f "$REPORT"' EXIT
+
+if [ ! -x P3.out ]
+then
+	echo "P3.out not found; run \"make\" in the top directory" >&2
+	exit 1
+fi
+
+# Translates forms copies of FORM and prints the peak RSS in KB
+translate ()
+{
+	forms=$1
+	start=$(date +%s)
+	defines=$( { yes "$FORM" | head -n "$forms"; echo "(main)"; } |
+		./P3.out --stream --time-phases=json 2> "$REPORT" | grep -c '^int ')
+	seconds=$(( $(date +%s) - start ))
+	peak=$(sed -n 's/.*"peak_rss_kb": \([0-9]*\).*/\1/p' "$REPORT")
+	if [ "$defines" != "$forms" ] || ! grep -q '^0 errors' "$REPORT"
+	then
+		echo "$forms forms: $defines defines translated" >&2
+		cat "$REPORT" >&2
+		exit 1
+	fi
+	echo "$(( forms * BYTES / 1048576 )) MB, $forms defines in $seconds s, peak RSS $peak KB" >&2
+	echo "$peak"
+}
+
+FORMS=$(( MB * 1048576 / BYTES ))
+SMALL=$(translate $(( FORMS / 8 ))) || exit 1
+LARGE=$(translate "$FORMS") || exit 1
+if [ "$LARGE" -gt $(( SMALL + SMALL / 4 + 1024 )) ]
+then
+	echo "FAIL: peak RSS grew from $SMALL KB to $LARGE KB" >&2
+	exit 1
+fi
+echo "PASS: peak RSS $LARGE KB for $MB MB, $SMALL KB for an eighth of it"
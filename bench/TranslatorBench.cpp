@@ -0,0 +1,160 @@
+/*******************************************************************************
+* Title: Translator throughput benchmark                                       *
+* Author: Seth Nuzum                                                           *
+* Date: 11-17-23                                                               *
+* File: TranslatorBench.cpp                                                    *
+*                                                                              *
+* Description: This program builds a corpus of PL460 programs from 1 KB to    *
+*              100 MB out of the statements in Statements.pl460, translates    *
+*              each one and prints the lexical analyzer's throughput and the   *
+*              whole translator's, in MB/s and tokens/s. Parsing and code      *
+*              generation are interleaved, so their time is taken from the     *
+*              translator's phase timer, in runs of their own, since timing    *
+*              every phase slows the others. The translator is also run        *
+*              pipelined, with the lexical analyzer and the writer on threads  *
+*              of their own, and its speedup over the serial run is shown.     *
+*              Each size is run once to warm up and then repeatedly; the       *
+*              median run is shown.                                            *
+*              Run it with "make bench", or "make bench BENCH_MAX=10000000"    *
+*              to stop at a smaller size.                                      *
+*******************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <sys/stat.h>
+#include <vector>
+#include "SyntacticalAnalyzer.h"
+
+using namespace std;
+
+static const long sizes [] = {1000, 10000, 100000, 1000000, 10000000, 100000000};
+static const double RUN_SECONDS = 2.0;	// time spent on the repeated runs of a size
+static const int MAX_RUNS = 5;
+
+/********************************************************************************/
+/* This function writes a program of about size bytes to prefix.pl460: a run   */
+/* of defines whose bodies are the statements read from Statements.pl460.      */
+/********************************************************************************/
+static void MakeProgram (const string & prefix, const string & statements, long size)
+{
+	ofstream out (prefix + ".pl460");
+	long written = 0;
+	for (int f = 1; written < size; f++)
+	{
+		string define = "(define (f" + to_string (f) + ")\n" + statements + ")\n\n";
+		out << define;
+		written += define.size ();
+	}
+	out << "(define (main)\n\t(display \"done\")\n\t(newline)\n)\n";
+}
+
+static double Seconds (chrono::steady_clock::time_point start)
+{
+	return chrono::duration <double> (chrono::steady_clock::now () - start).count ();
+}
+
+/********************************************************************************/
+/* These functions run the lexical analyzer alone, returning the number of     */
+/* tokens, and the whole translator, on prefix.pl460.                          */
+/********************************************************************************/
+static long Lex (const string & prefix)
+{
+	LexicalAnalyzer lex (prefix);
+	long tokens = 0;
+	while (lex.GetToken () != EOF_T)
+		tokens++;
+	return tokens;
+}
+
+static void Translate (const string & prefix)
+{
+	SyntacticalAnalyzer parser (prefix);
+}
+
+/********************************************************************************/
+/* This function translates prefix.pl460 with its phases timed and returns the */
+/* wall time charged to the parser and the code generator.                     */
+/********************************************************************************/
+static double ParseAndGenerate (const string & prefix)
+{
+	Phase::Start ();
+	Translate (prefix);
+	double seconds = Phase::Seconds (PARSE_P) + Phase::Seconds (GENERATE_P);
+	phaseTiming = false;
+	return seconds;
+}
+
+// The median of runs calls of seconds, each returning a time
+template <class F> static double MedianOf (F seconds, int runs)
+{
+	vector <double> times;
+	for (int r = 0; r < runs; r++)
+		times.push_back (seconds ());
+	sort (times.begin (), times.end ());
+	return times[times.size () / 2];
+}
+
+template <class F> static double Median (F run, int runs)
+{
+	return MedianOf ([&]
+	{
+		chrono::steady_clock::time_point start = chrono::steady_clock::now ();
+		run ();
+		return Seconds (start);
+	}, runs);
+}
+
+int main (int argc, char * argv [])
+{
+	long largest = argc > 1 ? atol (argv[1]) : sizes[5];
+	ifstream in ("bench/Statements.pl460");
+	if (!in)
+	{
+		cerr << "bench/Statements.pl460 not found; run from the top directory\n";
+		exit (1);
+	}
+	stringstream statements;
+	statements << in.rdbuf ();
+	mkdir ("bench/corpus", 0755);
+
+	// The analyzer reports its error count on cout; the benchmark's table goes to stdout
+	ofstream nowhere;
+	cout.rdbuf (nowhere.rdbuf ());
+
+	printf ("%10s %10s %10s %12s %12s %10s %12s %11s %7s %4s\n", "bytes", "tokens", "lex MB/s", "lex tok/s",
+		"parse+cg MB/s", "all MB/s", "all tok/s", "piped MB/s", "speedup", "runs");
+	for (long size : sizes)
+	{
+		if (size > largest)
+			break;
+		string prefix = "bench/corpus/" + to_string (size);
+		MakeProgram (prefix, statements.str (), size);
+		struct stat info;
+		stat ((prefix + ".pl460").c_str (), &info);
+		double megabytes = info.st_size / 1e6;
+
+		long tokens = 0;
+		chrono::steady_clock::time_point start = chrono::steady_clock::now ();
+		tokens = Lex (prefix);
+		Translate (prefix);
+		double warmup = Seconds (start);
+		int runs = max (1, min (MAX_RUNS, int (RUN_SECONDS / warmup)));
+
+		double lex = Median ([&] { Lex (prefix); }, runs);
+		double all = Median ([&] { Translate (prefix); }, runs);
+		double parse = MedianOf ([&] { return ParseAndGenerate (prefix); }, runs);
+		pipelined = true;
+		double piped = Median ([&] { Translate (prefix); }, runs);
+		pipelined = false;
+		printf ("%10ld %10ld %10.2f %12.0f %12.2f %10.2f %12.0f %11.2f %7.2f %4d\n", long (info.st_size), tokens,
+			megabytes / lex, tokens / lex, megabytes / parse,
+			megabytes / all, tokens / all, megabytes / piped, all / piped, runs);
+		fflush (stdout);
+	}
+	return 0;
+}
@@ -0,0 +1,254 @@
+/*******************************************************************************
+* Title: Object runtime tests                                                  *
+* Author: Seth Nuzum                                                           *
+* Date: 11-17-23                                                               *
+* File: ObjectTest.cpp                                                         *
+*                                                                              *
+* Description: This program checks cases of the Object runtime that have      *
+*              gone wrong before. Each case formats an Object and compares it  *
+*              with the expected text; the program prints each failure and     *
+*              exits with status 1 if there was one. Run it with "make check". *
+*******************************************************************************/
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Object.h"
+
+using namespace std;
+
+static int failures = 0;
+
+static void Check (const string & name, const Object & value, const string & expected)
+{
+	ostringstream out;
+	out << value;
+	if (out.str () != expected)
+	{
+		cout << "FAIL " << name << ": " << out.str () << ", expected " << expected << endl;
+		failures++;
+	}
+}
+
+/********************************************************************************/
+/* This function runs op in a child process, which the runtime ends on an      */
+/* error, and checks that it exits with status 1 after writing expected to    */
+/* cerr.                                                                        */
+/********************************************************************************/
+template <class F> static void CheckError (const string & name, F op, const string & expected)
+{
+	int channel [2];
+	if (pipe (channel) != 0)
+		exit (2);
+	pid_t child = fork ();
+	if (child == 0)
+	{
+		dup2 (channel[1], 2);
+		op ();
+		_exit (0);
+	}
+	close (channel[1]);
+	string text;
+	char part [256];
+	for (ssize_t n; (n = read (channel[0], part, sizeof (part))) > 0; )
+		text.append (part, n);
+	close (channel[0]);
+	int status = 0;
+	waitpid (child, &status, 0);
+	if (!WIFEXITED (status) || WEXITSTATUS (status) != 1 || text != expected + "\n")
+	{
+		cout << "FAIL " << name << ": \"" << text << "\", expected \"" << expected << "\"" << endl;
+		failures++;
+	}
+}
+
+static void CheckTruth (const string & name, const Object & value, bool expected)
+{
+	if (bool (value) != expected || bool (!value) == expected)
+	{
+		cout << "FAIL " << name << ": bool and ! disagree with " << expected << endl;
+		failures++;
+	}
+}
+
+/********************************************************************************/
+/* Reals at and just below 2^63, where a fixnum stops holding the value.       */
+/********************************************************************************/
+static void Rounding ()
+{
+	Check ("round 9.21e18", round (Object (9.21e18)), "9210000000000000000");
+	Check ("round -9.22e18", round (Object (-9.22e18)), "-9220000000000000000");
+	Check ("round 2^63", round (Object (9223372036854775808.0)), "9223372036854775808");
+	Check ("round -2^63", round (Object (-9223372036854775808.0)), "-9223372036854775808");
+	Check ("round below 2^63", round (Object (9223372036854774784.0)), "9223372036854774784");
+	Check ("round above -2^63", round (Object (-9223372036854774784.0)), "-9223372036854774784");
+	Check ("round 1e30", round (Object (1e30)), "1000000000000000019884624838656");
+	Check ("rational 2^63", Object (rational (9223372036854775808.0)), "9223372036854775808");
+	Check ("rational -2^63", Object (rational (-9223372036854775808.0)), "-9223372036854775808");
+}
+
+/********************************************************************************/
+/* Division by zero is reported as such, and numbers are true unless zero,     */
+/* whichever of bool and ! tests them.                                          */
+/********************************************************************************/
+static void Zeros ()
+{
+	CheckError ("1 / 0", [] { Object (1) / Object (0); }, "Division by zero: 1 / 0");
+	CheckError ("7 % 0", [] { Object (7) % Object (0); }, "Division by zero: 7 % 0");
+	CheckError ("1/2 / 0", [] { Object (rational (1, 2)) / Object (0); }, "Division by zero: 1/2 / 0");
+	CheckError ("2.5 / 0.0", [] { Object (2.5) / Object (0.0); }, "Division by zero: 2.5 / 0");
+	CheckTruth ("integer 3", Object (3), true);
+	CheckTruth ("integer 0", Object (0), false);
+	CheckTruth ("real 0.0", Object (0.0), false);
+	CheckTruth ("rational 1/2", Object (rational (1, 2)), true);
+	CheckTruth ("bigint", Object (string ("1180591620717411303424")), true);
+	CheckTruth ("#f", Object (boolean (false)), false);
+}
+
+/********************************************************************************/
+/* Hash tables: numbers equal by == are one key, whatever their type, and a     */
+/* table keeps every key through growing and re-probing.                        */
+/********************************************************************************/
+static void HashTables ()
+{
+	Object T = make_hash_table ();
+	Check ("empty hash-count", hash_count (T), "0");
+	hash_set (T, Object (1), Object (string ("\"a\"")));
+	hash_set (T, Object (1.0), Object (string ("\"b\"")));
+	hash_set (T, Object (rational (2, 2)), Object (string ("\"c\"")));
+	Check ("1, 1.0 and 2/2 are one key", hash_count (T), "1");
+	Check ("hash-ref 1", hash_ref (T, Object (1)), "\"c\"");
+	Check ("hash-ref 1.0", hash_ref (T, Object (1.0)), "\"c\"");
+	Check ("hash-ref 2/2", hash_ref (T, Object (rational (4, 4))), "\"c\"");
+	Check ("hash-ref 0.0 and -0.0", hash_ref (hash_set (make_hash_table (), Object (0.0), Object (7)), Object (-0.0)), "7");
+	Check ("one entry", T, "#hash((1 . \"c\"))");
+
+	Object U = make_hash_table ();
+	for (int i = 0; i < 1000; i++)
+	{
+		hash_set (U, Object (i), Object (i * i));
+		hash_set (U, Object (string ("\"k") + to_string (i) + "\""), Object (-i));
+	}
+	for (int i = 0; i < 1000; i += 100)
+		hash_set (U, Object (double (i)), Object (i));
+	Check ("hash-count after growing", hash_count (U), "2000");
+	Object sum (0);
+	for (int i = 0; i < 1000; i++)
+		sum = sum + hash_ref (U, Object (i)) + hash_ref (U, Object (string ("\"k") + to_string (i) + "\""));
+	// i * i and -i for i from 0 to 999, with i in place of i * i at multiples of 100
+	Check ("every key kept", sum, "329488500");
+	Check ("replaced through a real key", hash_ref (U, Object (300)), "300");
+	Check ("list key", hash_ref (hash_set (U, Object ("(a 1)"), Object (5)), Object ("(a 1.0)")), "5");
+
+	CheckError ("missing key", [] { hash_ref (make_hash_table (), Object (5)); }, "No value found for hash-ref key: 5");
+	CheckError ("hash-ref on a vector", [] { hash_ref (make_vector (Object (1), Object (0)), Object (0)); },
+		"Wrong type for hash-ref table: #(0) (vector)");
+}
+
+/********************************************************************************/
+/* Vectors: indexes are checked against the length, and vectors are formatted  */
+/* as #(...) wherever they appear.                                              */
+/********************************************************************************/
+static void Vectors ()
+{
+	Object V = make_vector (Object (3), Object (0));
+	vector_set (V, Object (0), Object (string ("\"s\"")));
+	vector_set (V, Object (2), make_vector (Object (2), Object (rational (1, 2))));
+	Check ("vector-ref", vector_ref (V, Object (0)), "\"s\"");
+	Check ("vector-length", vector_length (V), "3");
+	Check ("nested vector", V, "#(\"s\" 0 #(1/2 1/2))");
+	Check ("empty vector", make_vector (Object (0), Object (1)), "#()");
+	Check ("vector literal", Object ("#(a (b #(c)) #())"), "#(a (b #(c)) #())");
+	Check ("vector in a list", cons (make_vector (Object (1), Object (boolean (true))), Object ("()")), "(#(#t))");
+
+	CheckError ("vector-ref past the end", [] { vector_ref (make_vector (Object (2), Object (0)), Object (2)); },
+		"Wrong index for vector-ref: 2 (length 2)");
+	CheckError ("vector-set! below 0", [] { vector_set (make_vector (Object (2), Object (0)), Object (-1), Object (0)); },
+		"Wrong index for vector-set!: -1 (length 2)");
+	CheckError ("vector-ref with a real", [] { vector_ref (make_vector (Object (2), Object (0)), Object (1.0)); },
+		"Wrong index for vector-ref: 1 (length 2)");
+	CheckError ("make-vector -1", [] { make_vector (Object (-1), Object (0)); },
+		"Wrong type for make-vector length: -1 (integer)");
+}
+
+/********************************************************************************/
+/* Regions: nested ones share the arena, cells that escape an inner region are */
+/* kept alive through the outer ones, and collections run while one is open.   */
+/********************************************************************************/
+static long PeakKB ()
+{
+	struct rusage usage;
+	getrusage (RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+static unsigned long Minor ()
+{
+	ostringstream stats;
+	gc_stats (stats);
+	return stoul (stats.str ().substr (stats.str ().find (' ') + 1));
+}
+
+static int Nest (int depth)
+{
+	Region region;
+	Object V = make_vector (Object (4));
+	return depth ? Nest (depth - 1) + 1 : 0;
+}
+
+static void Regions ()
+{
+	long before = PeakKB ();
+	Nest (10000);
+	if (PeakKB () - before > 8192)
+	{
+		cout << "FAIL regions 10000 deep: peak grew by " << PeakKB () - before << " KB" << endl;
+		failures++;
+	}
+
+	Object keep = make_vector (Object (1));
+	{
+		Region outer;
+		Object table = make_hash_table ();
+		{
+			Region inner;
+			hash_set (table, Object (1), make_vector (Object (2), Object (7)));
+		}
+		vector_set (keep, Object (0), table);
+	}
+	{
+		Region again;
+		for (int i = 0; i < 1000; i++)
+			make_vector (Object (2), Object (i));
+	}
+	Check ("escaped from nested regions", hash_ref (vector_ref (keep, Object (0)), Object (1)), "#(7 7)");
+
+	unsigned long minor = Minor ();
+	{
+		Region region;
+		for (int i = 0; i < 200000; i++)
+			make_vector (Object (1));
+	}
+	if (Minor () == minor)
+	{
+		cout << "FAIL no collection while a region was open" << endl;
+		failures++;
+	}
+}
+
+int main ()
+{
+	Rounding ();
+	Zeros ();
+	HashTables ();
+	Vectors ();
+	Regions ();
+	if (failures)
+		exit (1);
+	cout << "All Object tests passed\n";
+	return 0;
+}